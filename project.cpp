@@ -3,11 +3,15 @@
 #include <sstream>
 #include <vector>
 #include <unordered_map>
+#include <unordered_set>
 #include <cstdint>
 #include <stdexcept>
-#include <tbb/concurrent_queue.h> 
-#include <tbb/concurrent_hash_map.h> 
 #include <tbb/parallel_for.h> 
+#include <tbb/global_control.h>
+#include <tbb/combinable.h>
+#include <tbb/enumerable_thread_specific.h>
+#include <tbb/task_group.h>
+#include <tbb/task_arena.h>
 #include <bitset>
 #include <cmath>
 #include <algorithm>
@@ -22,6 +26,21 @@
 #include <optional>
 #include <queue> 
 #include <iomanip> 
+#include <cstdlib>
+#include <memory>
+#include <memory_resource>
+#include <cstring>
+#include <random>
+#include <functional>
+#include <utility>
+#include <list>
+#include <mutex>
+#include <filesystem>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <sys/resource.h>
 
 using State = uint64_t;
 
@@ -38,7 +57,25 @@ enum class DiagonalOrientation {
 };
 
 inline int dirToIndex(Direction dir) {
-    return static_cast<int>(log2(static_cast<double>(dir)));
+    return __builtin_ctz(static_cast<unsigned>(dir));
+}
+
+// The far end of the opening on `edge` at (x, y): the cell on the opposite
+// edge of the same row or column. Returns false unless (x, y) is on `edge`.
+inline bool openingExit(int width, int height, int x, int y, Direction edge, int& exit_x, int& exit_y) {
+    exit_x = x;
+    exit_y = y;
+    switch (edge) {
+        case Direction::UP:    exit_y = height - 1; return y == 0;
+        case Direction::DOWN:  exit_y = 0;          return y == height - 1;
+        case Direction::LEFT:  exit_x = width - 1;  return x == 0;
+        case Direction::RIGHT: exit_x = 0;          return x == width - 1;
+    }
+    return false;
+}
+
+inline Direction opposite(Direction dir) {
+    return static_cast<Direction>(1 << (dirToIndex(dir) ^ 1));
 }
 
 class Board {
@@ -50,7 +87,8 @@ public:
     Board(int width, int height)
         : width(width), height(height),
           walls(height, std::vector<uint8_t>(width, 0)),
-          targetX(-1), targetY(-1), targetColor('\0'), targetRobot(-1) {}
+          targetX(-1), targetY(-1), targetColor('\0'), targetRobot(-1),
+          openings(height, std::vector<uint8_t>(width, 0)) {}
 
     void addWall(int x, int y, Direction dir) {
         validateCoordinates(x, y);
@@ -74,9 +112,19 @@ public:
         diagonalWalls[{x, y}] = {color, orientation};
     }
 
+    // Opens the board edge at (x, y): a robot sliding out through it comes
+    // back in on the opposite edge of the same row or column and keeps going.
+    // The opposite end is opened too, and the border walls on both are removed.
     void addOpening(int x, int y, Direction edge) {
         validateCoordinates(x, y);
-        openings.push_back({x, y, edge});
+        int ox, oy;
+        if (!openingExit(width, height, x, y, edge, ox, oy)) {
+            throw std::invalid_argument("An opening must be on the board edge it opens");
+        }
+        openings[y][x] |= static_cast<uint8_t>(edge);
+        openings[oy][ox] |= static_cast<uint8_t>(opposite(edge));
+        walls[y][x] &= static_cast<uint8_t>(~static_cast<uint8_t>(edge));
+        walls[oy][ox] &= static_cast<uint8_t>(~static_cast<uint8_t>(opposite(edge)));
     }
 
     void setTarget(int x, int y, char color) {
@@ -105,21 +153,8 @@ public:
     }
 
     bool isOpening(int x, int y, Direction edge) const {
-        bool on_edge = false;
-        switch (edge) {
-            case Direction::UP:    on_edge = (y == 0); break;
-            case Direction::DOWN:  on_edge = (y == height - 1); break;
-            case Direction::LEFT:  on_edge = (x == 0); break;
-            case Direction::RIGHT: on_edge = (x == width - 1); break;
-        }
-        if (!on_edge) return false;
-
-        for (const auto& opening : openings) {
-            if (std::get<0>(opening) == x && std::get<1>(opening) == y && std::get<2>(opening) == edge) {
-                return true;
-            }
-        }
-        return false;
+        if (x < 0 || x >= width || y < 0 || y >= height) return false;
+        return openings[y][x] & static_cast<uint8_t>(edge);
     }
 
     char getRobotColor(int index) const {
@@ -240,7 +275,7 @@ public:
         }
     }
 
-friend class Solver;
+friend class CompiledBoard;
 
 private:
     void validateCoordinates(int x, int y) const {
@@ -280,7 +315,7 @@ private:
     int targetRobot;
 
     std::map<std::pair<int, int>, std::pair<char, DiagonalOrientation>> diagonalWalls;
-    std::vector<std::tuple<int, int, Direction>> openings;
+    std::vector<std::vector<uint8_t>> openings;
 };
 
 const std::map<int, char> Board::robotIndexToColor = {
@@ -293,9 +328,12 @@ const std::map<int, char> Board::fileColorIndexToChar = {
     {0, 'R'}, {1, 'B'}, {2, 'G'}, {3, 'Y'}, {4, 'P'}
 };
 
-std::array<std::pair<int, int>, 5> decode(State s) {
-    std::array<std::pair<int, int>, 5> robots;
-    for (int i = 0; i < 5; ++i) {
+// Robot i lives in byte i of a State (x in the low nibble, y in the high
+// one), so an N-robot state only uses its low 8 * N bits.
+template <int Robots = 5>
+std::array<std::pair<int, int>, Robots> decode(State s) {
+    std::array<std::pair<int, int>, Robots> robots;
+    for (int i = 0; i < Robots; ++i) {
         uint8_t bits = (s >> (8*i)) & 0xFF;
         int x = bits & 0x0F;
         int y = (bits >> 4) & 0x0F;
@@ -304,246 +342,347 @@ std::array<std::pair<int, int>, 5> decode(State s) {
     return robots;
 }
 
-State encode(const std::array<std::pair<int, int>, 5>& robots) {
+template <size_t Robots>
+State encode(const std::array<std::pair<int, int>, Robots>& robots) {
     State s = 0;
-    for (int i = 0; i < 5; ++i) {
+    for (size_t i = 0; i < Robots; ++i) {
         s |= (static_cast<State>(robots[i].first & 0x0F)) << (8*i);
         s |= (static_cast<State>(robots[i].second & 0x0F)) << (8*i + 4);
     }
     return s;
 }
 
-struct TbbStateHashCompare {
-    static size_t hash(State s) {
-        return std::hash<State>()(s);
-    }
-    static bool equal(State s1, State s2) {
-        return s1 == s2;
-    }
-};
-
-struct Move {
-    int robot;
-    Direction dir;
-};
-
-class Solver {
-public:
-    Solver(const Board& board, State initial)
-        : board(board), initial(initial), targetRobot(board.targetRobot)
-    {
-        if (targetRobot < 0 || targetRobot >= 5) {
-            throw std::runtime_error("Target robot not set or invalid on the board before creating Solver.");
-        }
-    }
-
-    std::vector<Move> solve() {
-        tbb::concurrent_queue<State> queue;
-        tbb::concurrent_hash_map<State, std::pair<State, Move>, TbbStateHashCompare> visited;
-        std::vector<Move> solution;
-        State solution_state = 0;
-
-        queue.push(initial);
-        visited.insert({initial, {initial, {-1, Direction::UP}}});
-
-        std::atomic<bool> solutionFound = false;
-
-        while (!solutionFound && !queue.empty()) {
-            std::vector<State> current_level;
-            State s;
-            while (queue.try_pop(s)) current_level.push_back(s);
-
-            if (current_level.empty()) break;
-
-            tbb::parallel_for(tbb::blocked_range<size_t>(0, current_level.size()),
-                [&](const auto& r) {
-                    for (size_t i = r.begin(); i < r.end(); ++i) {
-                        if (solutionFound.load()) return;
-
-                        const State& current = current_level[i];
-                        auto robots = decode(current);
-
-                        if (checkSolution(current)) {
-                            bool expected = false;
-                            if (solutionFound.compare_exchange_strong(expected, true)) {
-                                solution_state = current;
-                            }
-                            return;
-                        }
-
-                        for (int robot_idx = 0; robot_idx < 5; ++robot_idx) {
-                            for (Direction dir : {Direction::UP, Direction::DOWN,
-                                                 Direction::LEFT, Direction::RIGHT}) {
-
-                                if (solutionFound.load()) return;
-
-                                auto [start_x, start_y] = robots[robot_idx];
-                                auto [nx, ny] = simulateMove(start_x, start_y, dir, robots, robot_idx);
+// A compiled cell is one byte: the low nibble is the Direction wall mask and
+// the high nibble the diagonal code (0 = none, else 1 + 2 * color id + orientation).
+inline uint8_t packDiagonal(int color_id, DiagonalOrientation orientation) {
+    return static_cast<uint8_t>((1 + 2 * color_id + static_cast<int>(orientation)) << 4);
+}
 
-                                if (start_x == nx && start_y == ny) continue;
+inline bool hasDiagonal(uint8_t cell) {
+    return (cell >> 4) != 0;
+}
 
-                                State new_state = encode(robots, robot_idx, nx, ny);
-                                Move move{robot_idx, dir};
+inline int diagonalColorId(uint8_t cell) {
+    return ((cell >> 4) - 1) >> 1;
+}
 
-                                tbb::concurrent_hash_map<State, std::pair<State, Move>, TbbStateHashCompare>::accessor acc;
-                                if (visited.insert(acc, new_state)) {
-                                    acc->second = {current, move};
-                                    queue.push(new_state);
-                                }
-                                acc.release();
-                            }
-                        }
-                    }
-                });
+inline DiagonalOrientation diagonalOrientation(uint8_t cell) {
+    return static_cast<DiagonalOrientation>(((cell >> 4) - 1) & 1);
+}
 
-            if (solutionFound.load()) break;
+inline Direction deflect(Direction entry_direction, DiagonalOrientation orientation) {
+    if (orientation == DiagonalOrientation::NW_SE) {
+        switch (entry_direction) {
+            case Direction::RIGHT: return Direction::DOWN;
+            case Direction::LEFT:  return Direction::UP;
+            case Direction::DOWN:  return Direction::RIGHT;
+            case Direction::UP:    return Direction::LEFT;
         }
-
-        if (solutionFound) {
-            solution = reconstructPath(visited, solution_state);
+    } else {
+        switch (entry_direction) {
+            case Direction::RIGHT: return Direction::UP;
+            case Direction::LEFT:  return Direction::DOWN;
+            case Direction::DOWN:  return Direction::LEFT;
+            case Direction::UP:    return Direction::RIGHT;
         }
-
-        return solution;
     }
+    return entry_direction;
+}
 
-    std::vector<Move> solve_sequential() {
-        std::queue<State> queue;
-        std::unordered_map<State, std::pair<State, Move>> visited; 
-        std::vector<Move> solution;
-        State solution_state = 0;
-        bool solutionFound = false; 
-
-        queue.push(initial);
-        visited[initial] = {initial, {-1, Direction::UP}}; 
-
-        while (!solutionFound && !queue.empty()) {
-            size_t level_size = queue.size();
-            for (size_t i = 0; i < level_size; ++i) {
-                State current = queue.front();
-                queue.pop();
-
-                auto robots = decode(current);
-
-                if (checkSolution(current)) {
-                    solution_state = current;
-                    solutionFound = true;
-                    break; 
-                }
-
-                for (int robot_idx = 0; robot_idx < 5; ++robot_idx) {
-                    for (Direction dir : {Direction::UP, Direction::DOWN,
-                                         Direction::LEFT, Direction::RIGHT}) {
-
-                        auto [start_x, start_y] = robots[robot_idx];
-                        auto [nx, ny] = simulateMove(start_x, start_y, dir, robots, robot_idx);
-
-                        if (start_x == nx && start_y == ny) continue;
-
-                        State new_state = encode(robots, robot_idx, nx, ny);
-                        Move move{robot_idx, dir};
-
-                        if (visited.find(new_state) == visited.end()) {
-                            visited[new_state] = {current, move};
-                            queue.push(new_state); 
-                        }
-                    }
+// Ricochet segments of one 8x8 quarter tile placed in one corner of a 16x16
+// board: every (cell, direction, color) walk up to where it stops inside the
+// tile or leaves it. Seam walls contributed by the neighbouring tile are not
+// part of the tile, so a leaving walk is checked against the composed board.
+// Paths are stored as board cells so SlideTable can stitch them directly.
+class QuadrantSlides {
+public:
+    static constexpr int SIZE = 8;
+
+    // `exit` is the direction index + 1 the walk leaves the tile in, or 0
+    // if it stopped. A walk that `loops` inside the tile is left unfinished.
+    struct Segment {
+        uint32_t offset;
+        uint16_t length;
+        uint8_t exit;
+        bool straight;
+        bool loops;
+    };
+
+    QuadrantSlides(const std::array<uint8_t, SIZE * SIZE>& tile, int originX, int originY)
+        : originX(originX), originY(originY), segments(SIZE * SIZE * 4 * 5) {
+        std::vector<uint32_t> seen(SIZE * SIZE * 4, 0);
+        uint32_t walk = 0;
+        for (int cell = 0; cell < SIZE * SIZE; ++cell) {
+            for (int d = 0; d < 4; ++d) {
+                for (int color = 0; color < 5; ++color) {
+                    segments[(cell * 4 + d) * 5 + color] = compile(tile, cell, d, color, seen, ++walk);
                 }
             }
-            if (solutionFound) break;
-        }
-
-        if (solutionFound) {
-            solution = reconstructPathSequential(visited, solution_state);
         }
+    }
 
-        return solution;
+    const Segment& segment(int boardCell, int dir, int colorId) const {
+        int local = ((boardCell >> 4) - originY) * SIZE + (boardCell & 15) - originX;
+        return segments[(static_cast<size_t>(local) * 4 + dir) * 5 + colorId];
     }
 
-    std::vector<Move> reconstructPath(
-        const tbb::concurrent_hash_map<State, std::pair<State, Move>, TbbStateHashCompare>& visited,
-        State endState) const {
+    const uint8_t* path(const Segment& s) const {
+        return cells.data() + s.offset;
+    }
 
-        std::vector<Move> path;
-        State current = endState;
-        while (true) {
-            tbb::concurrent_hash_map<State, std::pair<State, Move>, TbbStateHashCompare>::const_accessor acc;
-            if (!visited.find(acc, current)) {
-                std::cerr << "Error: State " << current << " not found during parallel path reconstruction!" << std::endl; 
-                path.clear(); 
+private:
+    Segment compile(const std::array<uint8_t, SIZE * SIZE>& tile, int start_cell, int dir,
+                    int color_id, std::vector<uint32_t>& seen, uint32_t walk) {
+        Segment s{static_cast<uint32_t>(cells.size()), 0, 0, true, false};
+        int x = start_cell % SIZE;
+        int y = start_cell / SIZE;
+        Direction move = static_cast<Direction>(1 << dir);
+        seen[start_cell * 4 + dir] = walk;
+
+        while (!(tile[y * SIZE + x] & static_cast<uint8_t>(move))) {
+            int next_x = x + (move == Direction::RIGHT) - (move == Direction::LEFT);
+            int next_y = y + (move == Direction::DOWN) - (move == Direction::UP);
+            if (next_x < 0 || next_x >= SIZE || next_y < 0 || next_y >= SIZE) {
+                s.exit = static_cast<uint8_t>(dirToIndex(move) + 1);
                 break;
             }
-            const auto& [prev_state, move] = acc->second;
-            acc.release(); 
-
-            if (move.robot == -1) { 
-                break;
+            uint8_t c = tile[next_y * SIZE + next_x];
+            if (c & static_cast<uint8_t>(1 << (dirToIndex(move) ^ 1))) break;
+
+            x = next_x;
+            y = next_y;
+            if (hasDiagonal(c) && diagonalColorId(c) != color_id) {
+                move = deflect(move, diagonalOrientation(c));
+                s.straight = false;
             }
+            cells.push_back(static_cast<uint8_t>((originY + y) << 4 | (originX + x)));
+            s.length++;
 
-            path.push_back(move);
-            if (current == prev_state) { 
-                std::cerr << "Error: Path reconstruction loop detected (parallel)! State " << current << " points to itself." << std::endl;
-                path.clear(); 
+            uint32_t& mark = seen[(y * SIZE + x) * 4 + dirToIndex(move)];
+            if (mark == walk) {
+                s.loops = true;
                 break;
             }
-            current = prev_state;
+            mark = walk;
         }
-        std::reverse(path.begin(), path.end());
-        return path;
+        return s;
     }
 
-    std::vector<Move> reconstructPathSequential(
-        const std::unordered_map<State, std::pair<State, Move>>& visited,
-        State endState) const {
+    int originX;
+    int originY;
+    std::vector<Segment> segments;
+    std::vector<uint8_t> cells;
+};
 
-        std::vector<Move> path;
-        State current = endState;
-        while (true) {
-            auto it = visited.find(current);
-            if (it == visited.end()) {
-                 std::cerr << "Error: State " << current << " not found during sequential path reconstruction!" << std::endl;
-                 path.clear(); 
-                 break;
+// Every (cell, direction, robot) ricochet path, walked once against walls and
+// diagonals. Robots are not part of the table; a move is resolved by scanning
+// its path for the first occupied cell.
+class SlideTable {
+public:
+    // `straight` slides are never deflected, so their path is a contiguous
+    // run of one row or column.
+    struct Entry {
+        uint32_t offset;
+        uint16_t length;
+        bool cyclic;
+        bool straight;
+    };
+
+    // A slide that passes through some cell: its start, direction index, and
+    // the position of that cell on the slide's path.
+    struct Origin {
+        uint8_t start;
+        uint8_t dir;
+        uint16_t step;
+    };
+
+    // `openings` holds, per cell, the border edges a slide may wrap through
+    // to the opposite side of the board; see Board::addOpening.
+    SlideTable(int width, int height, const std::array<uint8_t, 256>& grid,
+               const std::array<uint8_t, 256>& openings,
+               const std::array<uint8_t, 5>& robotColors)
+        : width(width), height(height),
+          entries(static_cast<size_t>(width) * height * 4 * 5) {
+        std::vector<uint32_t> seen(static_cast<size_t>(width) * height * 4, 0);
+        uint32_t walk = 0;
+        for (int cell = 0; cell < width * height; ++cell) {
+            for (Direction dir : {Direction::UP, Direction::DOWN,
+                                 Direction::LEFT, Direction::RIGHT}) {
+                for (int robot = 0; robot < 5; ++robot) {
+                    entries[index(cell, dir, robot)] =
+                        compile(grid, openings, cell, dir, robotColors[robot], seen, ++walk);
+                }
             }
-            const auto& [prev_state, move] = it->second;
+        }
+        indexOrigins();
+    }
 
-            if (move.robot == -1) { 
-                break;
+    // The same table for a 16x16 board composed from quarter tiles, stitched
+    // from the tiles' segments (top-left, top-right, bottom-right, bottom-left).
+    // Composed boards have no openings. Only a slide that comes back to its start cell can be cyclic; those are
+    // walked cell by cell instead.
+    SlideTable(const std::array<uint8_t, 256>& grid,
+               const std::array<const QuadrantSlides*, 4>& quadrants,
+               const std::array<uint8_t, 5>& robotColors)
+        : width(16), height(16), entries(16 * 16 * 4 * 5) {
+        std::vector<uint32_t> seen(16 * 16 * 4, 0);
+        uint32_t walk = 0;
+        for (int cell = 0; cell < 16 * 16; ++cell) {
+            for (Direction dir : {Direction::UP, Direction::DOWN,
+                                 Direction::LEFT, Direction::RIGHT}) {
+                for (int robot = 0; robot < 5; ++robot) {
+                    entries[index(cell, dir, robot)] =
+                        stitch(grid, quadrants, cell, dir, robotColors[robot], seen, ++walk);
+                }
             }
+        }
+        indexOrigins();
+    }
 
-            path.push_back(move);
+    const Entry& entry(int cell, Direction dir, int robot) const {
+        return entries[index(cell, dir, robot)];
+    }
 
-            if (current == prev_state) { 
-                std::cerr << "Error: Path reconstruction loop detected (sequential)! State " << current << " points to itself." << std::endl;
-                 path.clear(); 
-                 break;
+    const uint8_t* path(const Entry& e) const {
+        return cells.data() + e.offset;
+    }
+
+    // Every slide of `robot` whose path reaches `cell`, ignoring other robots.
+    std::pair<const Origin*, const Origin*> origins(int cell, int robot) const {
+        size_t i = static_cast<size_t>(cell) * 5 + robot;
+        return {originList.data() + originOffsets[i], originList.data() + originOffsets[i + 1]};
+    }
+
+    // Every slide of `robot` that comes to rest on `cell` against a wall,
+    // with no other robots on the board.
+    std::pair<const Origin*, const Origin*> stops(int cell, int robot) const {
+        size_t i = static_cast<size_t>(cell) * 5 + robot;
+        return {stopList.data() + stopOffsets[i], stopList.data() + stopOffsets[i + 1]};
+    }
+
+    // Reverse moves: every slide of `robot` that comes to rest on `cell` when
+    // the cells set in `blocked` hold the other robots. The path up to `cell`
+    // must be clear, and the slide must end there or run next into a blocker,
+    // exactly as a forward move resolves it; the robot's own start cell is
+    // empty once it moves, so a ricochet may cross it. Replaces `out`.
+    void arrivals(int cell, int robot, const std::array<uint64_t, 4>& blocked, std::vector<Origin>& out) const {
+        out.clear();
+        auto isBlocked = [&blocked](int c) { return (blocked[c >> 6] >> (c & 63)) & 1; };
+        if (isBlocked(cell)) return;
+        auto [first, last] = origins(cell, robot);
+        for (const Origin* o = first; o != last; ++o) {
+            if (o->start == cell || isBlocked(o->start)) continue;
+            const Entry& e = entries[index(o->start, static_cast<Direction>(1 << o->dir), robot)];
+            const uint8_t* p = path(e);
+            int k = 0;
+            while (k < o->step && !isBlocked(p[k])) k++;
+            if (k < o->step) continue;
+            bool rests = o->step + 1 == e.length ? !e.cyclic : isBlocked(p[o->step + 1]);
+            if (rests) out.push_back(*o);
+        }
+    }
+
+    static constexpr uint8_t UNREACHABLE = 0xFF;
+
+    // Backward distances: fewest moves for `robot` to reach `cell` from every
+    // cell, by a BFS from `cell` over reverse moves, with UNREACHABLE where
+    // there is no way. The other robots are left out, and with stopAnywhere a
+    // slide may also end on any cell it passes, as if a blocker stood just
+    // beyond it; that relaxation never overestimates, so it is the admissible one.
+    std::vector<uint8_t> distancesTo(int cell, int robot, bool stopAnywhere) const {
+        std::vector<uint8_t> dist(static_cast<size_t>(width) * height, UNREACHABLE);
+        std::vector<int> queue{cell};
+        dist[cell] = 0;
+        for (size_t head = 0; head < queue.size(); ++head) {
+            int at = queue[head];
+            auto [first, last] = stopAnywhere ? origins(at, robot) : stops(at, robot);
+            for (const Origin* o = first; o != last; ++o) {
+                if (dist[o->start] != UNREACHABLE) continue;
+                dist[o->start] = dist[at] + 1;
+                queue.push_back(o->start);
             }
-            current = prev_state;
         }
-        std::reverse(path.begin(), path.end());
-        return path;
+        return dist;
+    }
+
+    // The same with robots held fixed on the cells set in `blocked`: slides
+    // end against them, so these are exact distances for `robot` moving alone.
+    std::vector<uint8_t> distancesTo(int cell, int robot, const std::array<uint64_t, 4>& blocked) const {
+        std::vector<uint8_t> dist(static_cast<size_t>(width) * height, UNREACHABLE);
+        if ((blocked[cell >> 6] >> (cell & 63)) & 1) return dist;
+        std::vector<int> queue{cell};
+        std::vector<Origin> arrived;
+        dist[cell] = 0;
+        for (size_t head = 0; head < queue.size(); ++head) {
+            int at = queue[head];
+            arrivals(at, robot, blocked, arrived);
+            for (const Origin& o : arrived) {
+                if (dist[o.start] != UNREACHABLE) continue;
+                dist[o.start] = dist[at] + 1;
+                queue.push_back(o.start);
+            }
+        }
+        return dist;
     }
 
 private:
-    State encode(const std::array<std::pair<int, int>, 5>& current_robots,
-                 int robot_to_move, int next_x, int next_y) const {
-        auto temp_robots = current_robots;
-        temp_robots[robot_to_move] = {next_x, next_y};
-        return ::encode(temp_robots);
+    size_t index(int cell, Direction dir, int robot) const {
+        return (static_cast<size_t>(cell) * 4 + dirToIndex(dir)) * 5 + robot;
     }
 
-    std::pair<int, int> simulateMove(int start_x, int start_y, Direction initial_dir, 
-                                     const std::array<std::pair<int, int>, 5>& current_robots,
-                                     int moving_robot_index) const {
-        int curr_x = start_x;
-        int curr_y = start_y;
-        char moving_robot_color = board.getRobotColor(moving_robot_index);
-        Direction current_move_dir = initial_dir; 
+    void indexOrigins() {
+        const size_t cellCount = static_cast<size_t>(width) * height;
+        originOffsets.assign(cellCount * 5 + 1, 0);
+        for (size_t cell = 0; cell < cellCount; ++cell) {
+            for (int d = 0; d < 4; ++d) {
+                for (int robot = 0; robot < 5; ++robot) {
+                    const Entry& e = entries[(cell * 4 + d) * 5 + robot];
+                    for (int k = 0; k < e.length; ++k) {
+                        originOffsets[cells[e.offset + k] * 5 + robot + 1]++;
+                    }
+                }
+            }
+        }
+        for (size_t i = 1; i < originOffsets.size(); ++i) {
+            originOffsets[i] += originOffsets[i - 1];
+        }
+        originList.resize(originOffsets.back());
+        std::vector<uint32_t> fill(originOffsets.begin(), originOffsets.end() - 1);
+        for (size_t cell = 0; cell < cellCount; ++cell) {
+            for (int d = 0; d < 4; ++d) {
+                for (int robot = 0; robot < 5; ++robot) {
+                    const Entry& e = entries[(cell * 4 + d) * 5 + robot];
+                    for (int k = 0; k < e.length; ++k) {
+                        originList[fill[cells[e.offset + k] * 5 + robot]++] =
+                            {static_cast<uint8_t>(cell), static_cast<uint8_t>(d), static_cast<uint16_t>(k)};
+                    }
+                }
+            }
+        }
 
-        while (true) {
-            if (board.hasWall(curr_x, curr_y, current_move_dir)) {
-                break; 
+        // Wall stops: the origins at the last cell of a slide that is not cyclic.
+        stopOffsets.assign(cellCount * 5 + 1, 0);
+        stopList.clear();
+        for (size_t i = 0; i < cellCount * 5; ++i) {
+            size_t robot = i % 5;
+            for (uint32_t j = originOffsets[i]; j < originOffsets[i + 1]; ++j) {
+                const Origin& o = originList[j];
+                const Entry& e = entries[(static_cast<size_t>(o.start) * 4 + o.dir) * 5 + robot];
+                if (!e.cyclic && o.step + 1 == e.length) stopList.push_back(o);
             }
+            stopOffsets[i + 1] = static_cast<uint32_t>(stopList.size());
+        }
+    }
+
+    Entry compile(const std::array<uint8_t, 256>& grid, const std::array<uint8_t, 256>& openings,
+                  int start_cell, Direction dir, int color_id, std::vector<uint32_t>& seen, uint32_t walk) {
+        Entry e{static_cast<uint32_t>(cells.size()), 0, false, true};
+        int curr_x = start_cell % width;
+        int curr_y = start_cell / width;
+        Direction current_move_dir = dir;
+        seen[start_cell * 4 + dirToIndex(dir)] = walk;
 
+        while (!(grid[curr_y * width + curr_x] & static_cast<uint8_t>(current_move_dir))) {
             int next_x = curr_x;
             int next_y = curr_y;
             Direction opposite_dir;
@@ -552,166 +691,4135 @@ private:
                 case Direction::DOWN:  next_y++; opposite_dir = Direction::UP;   break;
                 case Direction::LEFT:  next_x--; opposite_dir = Direction::RIGHT; break;
                 case Direction::RIGHT: next_x++; opposite_dir = Direction::LEFT;  break;
-                default: return {curr_x, curr_y}; 
+                default: return e;
             }
 
-            if (next_x < 0 || next_x >= board.getWidth() || next_y < 0 || next_y >= board.getHeight()) {
-                break; 
+            if (next_x < 0 || next_x >= width || next_y < 0 || next_y >= height) {
+                if (!(openings[curr_y * width + curr_x] & static_cast<uint8_t>(current_move_dir))) break;
+                openingExit(width, height, curr_x, curr_y, current_move_dir, next_x, next_y);
+                e.straight = false;
             }
 
-            if (board.hasWall(next_x, next_y, opposite_dir)) {
-                break; 
+            int next_cell = next_y * width + next_x;
+            if (grid[next_cell] & static_cast<uint8_t>(opposite_dir)) break;
+
+            curr_x = next_x;
+            curr_y = next_y;
+
+            uint8_t c = grid[next_cell];
+            if (hasDiagonal(c) && diagonalColorId(c) != color_id) {
+                current_move_dir = deflect(current_move_dir, diagonalOrientation(c));
+                e.straight = false;
             }
 
-            bool collision = false;
-            for (int i = 0; i < 5; ++i) {
-                if (i == moving_robot_index) continue;
-                if (current_robots[i].first == next_x && current_robots[i].second == next_y) {
-                    collision = true;
-                    break;
-                }
+            cells.push_back(static_cast<uint8_t>(next_cell));
+            e.length++;
+
+            // Ricochets are reversible, so a walk that never stops comes back
+            // to its own start; such a slide only ends against a robot.
+            uint32_t& mark = seen[next_cell * 4 + dirToIndex(current_move_dir)];
+            if (mark == walk) {
+                e.cyclic = true;
+                break;
+            }
+            mark = walk;
+        }
+        return e;
+    }
+
+    Entry stitch(const std::array<uint8_t, 256>& grid,
+                 const std::array<const QuadrantSlides*, 4>& quadrants, int start_cell,
+                 Direction dir, int color_id, std::vector<uint32_t>& seen, uint32_t walk) {
+        Entry e{static_cast<uint32_t>(cells.size()), 0, false, true};
+        auto walkInstead = [&]() {
+            cells.resize(e.offset);
+            static const std::array<uint8_t, 256> NO_OPENINGS{};
+            return compile(grid, NO_OPENINGS, start_cell, dir, color_id, seen, walk);
+        };
+        int cell = start_cell;
+        int d = dirToIndex(dir);
+        for (;;) {
+            int x = cell & 15;
+            int y = cell >> 4;
+            const QuadrantSlides& quadrant = *quadrants[y < 8 ? (x >= 8) : 3 - (x >= 8)];
+            const QuadrantSlides::Segment& s = quadrant.segment(cell, d, color_id);
+            const uint8_t* path = quadrant.path(s);
+            cells.insert(cells.end(), path, path + s.length);
+            e.length += s.length;
+            e.straight = e.straight && s.straight;
+            if (s.loops || (!e.straight && std::find(path, path + s.length, start_cell) != path + s.length)) {
+                return walkInstead();
             }
-            if (collision) {
-                break; 
+            if (!s.exit) return e;
+
+            // Cross the seam, checking the walls the neighbouring tile adds.
+            if (s.length) cell = path[s.length - 1];
+            d = s.exit - 1;
+            if (grid[cell] & (1 << d)) return e;
+            x = (cell & 15) + (d == 3) - (d == 2);
+            y = (cell >> 4) + (d == 1) - (d == 0);
+            if (x < 0 || x >= 16 || y < 0 || y >= 16) return e;
+            cell = y << 4 | x;
+            if (grid[cell] & (1 << (d ^ 1))) return e;
+            if (cell == start_cell) return walkInstead();
+            if (hasDiagonal(grid[cell]) && diagonalColorId(grid[cell]) != color_id) {
+                d = dirToIndex(deflect(static_cast<Direction>(1 << d), diagonalOrientation(grid[cell])));
+                e.straight = false;
             }
+            cells.push_back(static_cast<uint8_t>(cell));
+            e.length++;
+        }
+    }
 
-            auto diag_info = board.getDiagonalWallInfo(next_x, next_y);
-            if (diag_info) {
-                auto [wall_color, orientation] = *diag_info;
-                if (wall_color != moving_robot_color) {
-                    curr_x = next_x;
-                    curr_y = next_y;
+    int width;
+    int height;
+    std::vector<Entry> entries;
+    std::vector<uint8_t> cells;
+    std::vector<uint32_t> originOffsets;
+    std::vector<Origin> originList;
+    std::vector<uint32_t> stopOffsets;
+    std::vector<Origin> stopList;
+};
 
-                    Direction entry_direction = current_move_dir; 
-                    Direction next_move_dir = current_move_dir; 
+// A board already in the compiled cell layout, as produced by the fast
+// loaders: walls mirrored onto both neighbours, diagonals in the high nibble.
+// Robot positions are optional (robotCount 0) and stored as state bytes.
+// `openings` has the edge bits of every open border, at both ends, with the
+// matching border walls already cleared from `cells`.
+struct BoardImage {
+    int width = 0;
+    int height = 0;
+    std::array<uint8_t, 256> cells{};
+    std::array<uint8_t, 256> openings{};
+    int targetRobot = -1;
+    int targetCell = -1;
+    int robotCount = 0;
+    std::array<uint8_t, 5> robots{};
+};
 
-                    if (orientation == DiagonalOrientation::NW_SE) { 
-                        if (entry_direction == Direction::RIGHT) next_move_dir = Direction::DOWN;
-                        else if (entry_direction == Direction::LEFT) next_move_dir = Direction::UP;
-                        else if (entry_direction == Direction::DOWN) next_move_dir = Direction::RIGHT;
-                        else if (entry_direction == Direction::UP) next_move_dir = Direction::LEFT;
-                    } else { 
-                        if (entry_direction == Direction::RIGHT) next_move_dir = Direction::UP;
-                        else if (entry_direction == Direction::LEFT) next_move_dir = Direction::DOWN;
-                        else if (entry_direction == Direction::DOWN) next_move_dir = Direction::LEFT;
-                        else if (entry_direction == Direction::UP) next_move_dir = Direction::RIGHT;
-                    }
+// A 16x16 board composed from quarter tiles: the composed cells plus each
+// placed tile's segments (top-left, top-right, bottom-right, bottom-left).
+struct BoardLayout {
+    BoardImage image;
+    std::array<const QuadrantSlides*, 4> quadrants{};
+};
 
-                    current_move_dir = next_move_dir;
+// Immutable solver view of a Board: walls and diagonals packed into one
+// 256-byte cell array, integer color ids, and the slide tables built on top.
+// Compile once per puzzle; Board stays the editable/loading type.
+class CompiledBoard {
+public:
+    explicit CompiledBoard(const Board& board)
+        : width(board.getWidth()), height(board.getHeight()),
+          grid(pack(board)), exits(packOpenings(board)), robotColors(colorIds()),
+          targetRobot(board.targetRobot),
+          targetCell(board.targetRobot >= 0 ? board.targetY * board.getWidth() + board.targetX : -1),
+          slides(width, height, grid, exits, robotColors) {}
+
+    explicit CompiledBoard(const BoardImage& image)
+        : width(image.width), height(image.height),
+          grid(image.cells), exits(image.openings), robotColors(colorIds()),
+          targetRobot(image.targetRobot), targetCell(image.targetCell),
+          slides(width, height, grid, exits, robotColors) {
+        if (width < 1 || width > 16 || height < 1 || height > 16) {
+            throw std::invalid_argument("Compiled boards are limited to 16x16 cells");
+        }
+    }
 
-                    continue; 
-                }
-            }
+    explicit CompiledBoard(const BoardLayout& layout)
+        : width(layout.image.width), height(layout.image.height),
+          grid(layout.image.cells), exits{}, robotColors(colorIds()),
+          targetRobot(layout.image.targetRobot), targetCell(layout.image.targetCell),
+          slides(grid, layout.quadrants, robotColors) {}
 
-            curr_x = next_x;
-            curr_y = next_y;
+    int getWidth() const { return width; }
+    int getHeight() const { return height; }
+    int getTargetRobot() const { return targetRobot; }
+    int getTargetCell() const { return targetCell; }
+    uint8_t cell(int index) const { return grid[index]; }
+    uint8_t openings(int index) const { return exits[index]; }
+    int robotColorId(int robot) const { return robotColors[robot]; }
+    bool hasDiagonalColor(int colorId) const {
+        for (int i = 0; i < width * height; ++i) {
+            if (hasDiagonal(grid[i]) && diagonalColorId(grid[i]) == colorId) return true;
+        }
+        return false;
+    }
+    const SlideTable& getSlides() const { return slides; }
+
+    // FNV-1a over the dimensions, packed cells and any openings; identifies
+    // a layout in files that are only valid for one board. Boards without
+    // openings hash as they did before openings existed.
+    uint64_t fingerprint() const {
+        uint64_t h = 0xCBF29CE484222325ull;
+        auto mix = [&h](uint8_t byte) { h = (h ^ byte) * 0x100000001B3ull; };
+        mix(static_cast<uint8_t>(width));
+        mix(static_cast<uint8_t>(height));
+        for (int i = 0; i < width * height; ++i) mix(grid[i]);
+        if (std::any_of(exits.begin(), exits.end(), [](uint8_t e) { return e != 0; })) {
+            for (int i = 0; i < width * height; ++i) mix(exits[i]);
+        }
+        return h;
+    }
+
+private:
+    static std::array<uint8_t, 256> pack(const Board& board) {
+        if (board.getWidth() > 16 || board.getHeight() > 16) {
+            throw std::invalid_argument("Compiled boards are limited to 16x16 cells");
+        }
+        std::array<uint8_t, 256> packed{};
+        for (int y = 0; y < board.getHeight(); ++y) {
+            for (int x = 0; x < board.getWidth(); ++x) {
+                packed[y * board.getWidth() + x] = board.walls[y][x] & 0x0F;
+            }
+        }
+        for (const auto& [pos, diag] : board.diagonalWalls) {
+            packed[pos.second * board.getWidth() + pos.first] |=
+                packDiagonal(Board::robotColorToIndex.at(diag.first), diag.second);
+        }
+        return packed;
+    }
 
+    static std::array<uint8_t, 256> packOpenings(const Board& board) {
+        std::array<uint8_t, 256> packed{};
+        for (int y = 0; y < board.getHeight(); ++y) {
+            for (int x = 0; x < board.getWidth(); ++x) {
+                packed[y * board.getWidth() + x] = board.openings[y][x];
+            }
         }
-        return {curr_x, curr_y}; 
+        return packed;
     }
 
-    bool checkSolution(State s) const {
-        auto pos = decode(s)[targetRobot];
-        return pos.first == board.targetX && pos.second == board.targetY;
+    static std::array<uint8_t, 5> colorIds() {
+        std::array<uint8_t, 5> ids;
+        for (int robot = 0; robot < 5; ++robot) {
+            ids[robot] = static_cast<uint8_t>(Board::robotColorToIndex.at(Board::robotIndexToColor.at(robot)));
+        }
+        return ids;
     }
 
-    const Board& board;
-    State initial;
+    int width;
+    int height;
+    std::array<uint8_t, 256> grid;
+    std::array<uint8_t, 256> exits;
+    std::array<uint8_t, 5> robotColors;
     int targetRobot;
+    int targetCell;
+    SlideTable slides;
 };
 
-const std::unordered_map<int, std::vector<Direction>> wallMapping = {
-    {0,  {}},
-    {1,  {Direction::UP}},
-    {2,  {Direction::DOWN}}, 
-    {3,  {Direction::UP, Direction::DOWN}}, 
-    {4,  {Direction::LEFT}}, 
-    {5,  {Direction::UP, Direction::LEFT}}, 
-    {6,  {Direction::DOWN, Direction::LEFT}}, 
-    {7,  {Direction::UP, Direction::DOWN, Direction::LEFT}}, 
-    {8,  {Direction::RIGHT}}, 
-    {9,  {Direction::UP, Direction::RIGHT}}, 
-    {10, {Direction::DOWN, Direction::RIGHT}}, 
-    {11, {Direction::UP, Direction::DOWN, Direction::RIGHT}}, 
-    {12, {Direction::LEFT, Direction::RIGHT}}, 
-    {13, {Direction::UP, Direction::LEFT, Direction::RIGHT}}, 
-    {14, {Direction::DOWN, Direction::LEFT, Direction::RIGHT}}, 
-    {15, {Direction::UP, Direction::DOWN, Direction::LEFT, Direction::RIGHT}} 
+struct Move {
+    int robot;
+    Direction dir;
 };
 
-void loadFromFile(Board& board, const std::string& filename) {
-    std::ifstream file(filename);
-    if (!file.is_open()) {
-        throw std::runtime_error("Could not open file: " + filename);
-    }
+struct Goal {
+    int robot;
+    int cell;
+};
 
-    std::string line;
-    int y = 0;
-    int boardHeight = board.getHeight();
-    int boardWidth = board.getWidth();
+// One BFS depth, IDA* iteration, bidirectional expansion step, or staged
+// search stage (depth 0 target only, 1 with one helper, 2 all robots). Move and
+// insert times are measured on a sample of expanded states and scaled up, so
+// the clock stays off the hot path; `bytes` approximates the footprint of the
+// visited table and frontier at the end of the level.
+struct LevelStats {
+    int depth = 0;
+    uint64_t frontier = 0;
+    uint64_t inserted = 0;
+    uint64_t duplicates = 0;
+    double loadFactor = 0;
+    double moveSeconds = 0;
+    double insertSeconds = 0;
+    size_t bytes = 0;
+    double seconds = 0;
+};
 
-    while (std::getline(file, line) && y < boardHeight) {
-        if (line.empty() || line[0] == '#') continue;
+// A child state and the move that produced it. `to()` is the moved robot's
+// new position byte.
+struct Successor {
+    State state;
+    int robot;
+    Direction dir;
 
-        std::istringstream iss(line);
-        int x = 0;
-        int value;
+    uint8_t to() const { return static_cast<uint8_t>(state >> (8 * robot)); }
+};
 
-        while (iss >> value && x < boardWidth) {
-            if (value >= 0 && value <= 15) {
-                if (value & static_cast<int>(Direction::UP))    board.addWall(x, y, Direction::UP);
-                if (value & static_cast<int>(Direction::DOWN))  board.addWall(x, y, Direction::DOWN);
-                if (value & static_cast<int>(Direction::LEFT))  board.addWall(x, y, Direction::LEFT);
-                if (value & static_cast<int>(Direction::RIGHT)) board.addWall(x, y, Direction::RIGHT);
-            } else if (value >= 16 && value <= 25) {
+// Counters from the most recent solve on a Solver. A cancelled search returns
+// no moves but still proves that no solution of exhaustedDepth moves or fewer
+// exists (-1 when not even the start was checked).
+struct SearchStats {
+    uint64_t expanded = 0;
+    std::vector<LevelStats> levels;
+    int exhaustedDepth = -1;
+    bool cancelled = false;
+};
+
+// Anonymous zero-filled mapping for large tables. With `hugePages` it first
+// asks for explicit huge pages and otherwise advises transparent ones; both
+// are only hints, so a plain mapping is the fallback. Untouched pages cost
+// only address space.
+class PageMapping {
+public:
+    PageMapping() = default;
+
+    PageMapping(size_t bytes, bool hugePages) : length(bytes) {
+        if (hugePages && bytes % HUGE_PAGE_BYTES == 0) {
+            base = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+            if (base == MAP_FAILED) base = nullptr;
+        }
+        if (!base) {
+            base = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if (base == MAP_FAILED) throw std::bad_alloc();
+            if (hugePages && bytes >= HUGE_PAGE_BYTES) madvise(base, bytes, MADV_HUGEPAGE);
+        }
+    }
+
+    PageMapping(PageMapping&& other) noexcept
+        : base(std::exchange(other.base, nullptr)), length(std::exchange(other.length, 0)) {}
+
+    PageMapping& operator=(PageMapping&& other) noexcept {
+        std::swap(base, other.base);
+        std::swap(length, other.length);
+        return *this;
+    }
+
+    ~PageMapping() {
+        if (base) munmap(base, length);
+    }
+
+    void* data() const { return base; }
+    size_t size() const { return length; }
+
+    // Gives up ownership; the caller unmaps the returned pages.
+    void* release() {
+        length = 0;
+        return std::exchange(base, nullptr);
+    }
+
+    // Zero-fills the whole mapping, handing resident pages back to the kernel.
+    void clear() {
+        if (madvise(base, length, MADV_DONTNEED) != 0) std::memset(base, 0, length);
+    }
+
+    static constexpr size_t HUGE_PAGE_BYTES = size_t{2} << 20;
+
+private:
+    void* base = nullptr;
+    size_t length = 0;
+};
+
+// Open-addressing visited/parent table for the parallel solver. Each slot is
+// one 64-bit word claimed with a single CAS:
+//   bits  0-39  state
+//   bits 40-47  previous cell byte of the robot that just moved
+//   bits 48-50  slot that robot occupies in this state (7 = root)
+//   bits 51-52  direction index
+//   bits 53-62  generation
+//   bit  63     occupied
+// Capacity is the largest power of two that fits the memory budget; the
+// backing pages are mapped lazily, so an oversized budget costs only address
+// space. reset() empties the table by starting a new generation: slots of
+// older generations read as free, so nothing is cleared between solves.
+class VisitedTable {
+public:
+    enum class InsertResult { Inserted, Present, Full };
+
+    explicit VisitedTable(size_t memoryBudgetBytes, bool hugePages = false)
+        : capacity(slotsFor(memoryBudgetBytes)), mask(capacity - 1),
+          pages(capacity * sizeof(uint64_t), hugePages),
+          slots(static_cast<std::atomic<uint64_t>*>(pages.data())) {}
+
+    // `move.robot` is the slot the moved robot occupies in `s` and `from` its
+    // byte before the move; a negative robot marks the root.
+    InsertResult insert(State s, Move move, uint8_t from) {
+        uint64_t packed = pack(s, move, from);
+        size_t i = hash(s) & mask;
+        for (size_t probe = 0; probe < MAX_PROBE; ++probe, i = (i + 1) & mask) {
+            uint64_t slot = slots[i].load(std::memory_order_acquire);
+            if (!live(slot)) {
+                if (slots[i].compare_exchange_strong(slot, packed, std::memory_order_acq_rel)) {
+                    return InsertResult::Inserted;
+                }
+            }
+            if ((slot & STATE_MASK) == s) return InsertResult::Present;
+        }
+        return InsertResult::Full;
+    }
+
+    bool find(State s, Move& move, uint8_t& from) const {
+        size_t i = hash(s) & mask;
+        for (size_t probe = 0; probe < MAX_PROBE; ++probe, i = (i + 1) & mask) {
+            uint64_t slot = slots[i].load(std::memory_order_acquire);
+            if (!live(slot)) return false;
+            if ((slot & STATE_MASK) == s) {
+                int robot = (slot >> 48) & 0x7;
+                from = static_cast<uint8_t>(slot >> 40);
+                if (robot == ROOT) {
+                    move = {-1, Direction::UP};
+                } else {
+                    move = {robot, static_cast<Direction>(1 << ((slot >> 51) & 0x3))};
+                }
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Forgets every state. Not safe while other threads are inserting.
+    void reset() {
+        if (++generation > MAX_GENERATION) {
+            pages.clear();
+            generation = 1;
+        }
+        tag = OCCUPIED | generation << 53;
+    }
+
+    size_t getCapacity() const { return capacity; }
+
+private:
+    static constexpr uint64_t STATE_MASK = (uint64_t{1} << 40) - 1;
+    static constexpr uint64_t OCCUPIED = uint64_t{1} << 63;
+    static constexpr uint64_t TAG_MASK = ~((uint64_t{1} << 53) - 1);
+    static constexpr uint64_t MAX_GENERATION = (uint64_t{1} << 10) - 1;
+    static constexpr int ROOT = 7;
+    static constexpr size_t MAX_PROBE = 4096;
+
+    static size_t slotsFor(size_t bytes) {
+        size_t n = 1024;
+        while (n * 2 * sizeof(uint64_t) <= bytes) n *= 2;
+        return n;
+    }
+
+    static size_t hash(State s) {
+        uint64_t h = s * 0x9E3779B97F4A7C15ull;
+        return static_cast<size_t>(h ^ (h >> 29));
+    }
+
+    bool live(uint64_t slot) const { return (slot & TAG_MASK) == tag; }
+
+    uint64_t pack(State s, Move move, uint8_t from) const {
+        uint64_t packed = tag | (s & STATE_MASK);
+        if (move.robot < 0) {
+            return packed | (uint64_t{ROOT} << 48);
+        }
+        packed |= static_cast<uint64_t>(from) << 40;
+        packed |= static_cast<uint64_t>(move.robot) << 48;
+        packed |= static_cast<uint64_t>(dirToIndex(move.dir)) << 51;
+        return packed;
+    }
+
+    size_t capacity;
+    size_t mask;
+    PageMapping pages;
+    std::atomic<uint64_t>* slots;
+    uint64_t generation = 1;
+    uint64_t tag = OCCUPIED | uint64_t{1} << 53;
+};
+
+// Growable visited set for the sequential solver that stores no parent
+// state. Each slot is one 64-bit word:
+//   bits  0-39  state
+//   bits 40-42  slot the moved robot occupies in this state (7 = root)
+//   bits 43-44  direction index
+//   bits 45-52  BFS depth
+//   bit  63     occupied
+// The parent is recovered by trying every start cell that slides onto the
+// robot's cell in that direction and keeping the one stored a level up.
+// Only the first mask + 1 slots are in use; reset() shrinks back to them
+// without giving up the larger vectors, so a reused table stops allocating.
+class CompactParentTable {
+public:
+    CompactParentTable() : slots(INITIAL_SLOTS, 0), mask(INITIAL_SLOTS - 1) {}
+
+    // `slot` is where the moved robot sits in `s`; negative marks the root.
+    bool insert(State s, int slot, Direction dir, int depth) {
+        if ((count + 1) * 10 > (mask + 1) * 7) grow();
+        uint64_t packed = OCCUPIED | s | static_cast<uint64_t>(depth) << 45;
+        packed |= slot < 0 ? uint64_t{ROOT} << 40
+                           : static_cast<uint64_t>(slot) << 40 | static_cast<uint64_t>(dirToIndex(dir)) << 43;
+        for (size_t i = hash(s) & mask; ; i = (i + 1) & mask) {
+            if (slots[i] == 0) {
+                slots[i] = packed;
+                count++;
+                return true;
+            }
+            if ((slots[i] & STATE_MASK) == s) return false;
+        }
+    }
+
+    // Returns the packed word for `s`, or 0 when absent.
+    uint64_t find(State s) const {
+        for (size_t i = hash(s) & mask; slots[i] != 0; i = (i + 1) & mask) {
+            if ((slots[i] & STATE_MASK) == s) return slots[i];
+        }
+        return 0;
+    }
+
+    static bool isRoot(uint64_t word) { return ((word >> 40) & 0x7) == ROOT; }
+    static int slotOf(uint64_t word) { return (word >> 40) & 0x7; }
+    static Direction direction(uint64_t word) { return static_cast<Direction>(1 << ((word >> 43) & 0x3)); }
+    static int depth(uint64_t word) { return (word >> 45) & 0xFF; }
+
+    void reset() {
+        std::fill(slots.begin(), slots.begin() + mask + 1, 0);
+        mask = INITIAL_SLOTS - 1;
+        count = 0;
+    }
+
+    size_t size() const { return count; }
+    size_t bytes() const { return (mask + 1) * sizeof(uint64_t); }
+    double loadFactor() const { return static_cast<double>(count) / (mask + 1); }
+
+private:
+    static constexpr uint64_t STATE_MASK = (uint64_t{1} << 40) - 1;
+    static constexpr uint64_t OCCUPIED = uint64_t{1} << 63;
+    static constexpr int ROOT = 7;
+    static constexpr size_t INITIAL_SLOTS = 1024;
+
+    static size_t hash(State s) {
+        uint64_t h = s * 0x9E3779B97F4A7C15ull;
+        return static_cast<size_t>(h ^ (h >> 29));
+    }
+
+    void grow() {
+        size_t used = mask + 1;
+        old.assign(slots.begin(), slots.begin() + used);
+        if (slots.size() < used * 2) slots.resize(used * 2);
+        std::fill(slots.begin(), slots.begin() + used * 2, 0);
+        mask = used * 2 - 1;
+        for (uint64_t word : old) {
+            if (word == 0) continue;
+            size_t i = hash(word & STATE_MASK) & mask;
+            while (slots[i] != 0) i = (i + 1) & mask;
+            slots[i] = word;
+        }
+    }
+
+    std::vector<uint64_t> slots;
+    std::vector<uint64_t> old;
+    size_t mask;
+    size_t count = 0;
+};
+
+// Memory resource for search pools: blocks of at least a huge page are
+// mapped with PageMapping (huge pages when `hugePages` is set), smaller ones
+// come from the default heap.
+class PageResource : public std::pmr::memory_resource {
+public:
+    explicit PageResource(bool hugePages) : hugePages(hugePages) {}
+
+private:
+    static size_t mappedBytes(size_t bytes) {
+        return (bytes + PageMapping::HUGE_PAGE_BYTES - 1) / PageMapping::HUGE_PAGE_BYTES * PageMapping::HUGE_PAGE_BYTES;
+    }
+
+    void* do_allocate(size_t bytes, size_t alignment) override {
+        if (bytes < PageMapping::HUGE_PAGE_BYTES) {
+            return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+        }
+        return PageMapping(mappedBytes(bytes), hugePages).release();
+    }
+
+    void do_deallocate(void* p, size_t bytes, size_t alignment) override {
+        if (bytes < PageMapping::HUGE_PAGE_BYTES) {
+            std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+        } else {
+            munmap(p, mappedBytes(bytes));
+        }
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+
+    bool hugePages;
+};
+
+// Search structures kept from one solve to the next. A solver given an arena
+// resets these tables and buffers instead of building and freeing its own,
+// so a worker that runs many small solves stops paying for malloc/free and
+// first-touch page faults. Hash-map nodes come from a pool that keeps its
+// chunks, and large tables and chunks ask for huge pages. An arena holds on
+// to the memory of the largest solve it has run. One solve at a time per
+// arena; see SearchArenaPool for concurrent solves.
+class SearchArena {
+public:
+    using ParentMap = std::pmr::unordered_map<State, std::pair<State, Move>>;
+
+    // Level frontiers of a BFS, plus a child buffer per parallel worker.
+    struct Frontiers {
+        std::vector<State> current;
+        std::vector<State> next;
+        tbb::enumerable_thread_specific<std::vector<State>> buffers;
+    };
+
+    // IDA* transposition slots and move stack. Slots are tagged with the
+    // iteration that wrote them, and the counter carries over between
+    // solves, so the table is only cleared when the 16-bit tag runs out.
+    struct Transpositions {
+        std::vector<uint64_t> slots;
+        uint64_t iteration = 0;
+        std::vector<Move> path;
+    };
+
+    explicit SearchArena(bool hugePages = true)
+        : hugePages(hugePages), pages(hugePages), nodes(&pages), parentMap(&nodes) {}
+
+    SearchArena(const SearchArena&) = delete;
+    SearchArena& operator=(const SearchArena&) = delete;
+
+    // The parallel visited table for this budget, emptied. It is mapped on
+    // first use and again only when the budget changes.
+    VisitedTable& visited(size_t memoryBudgetBytes) {
+        if (table && tableBudget == memoryBudgetBytes) {
+            table->reset();
+        } else {
+            table.reset();
+            table = std::make_unique<VisitedTable>(memoryBudgetBytes, hugePages);
+            tableBudget = memoryBudgetBytes;
+        }
+        return *table;
+    }
+
+    // Emptied; the map keeps its buckets and the pool its nodes.
+    ParentMap& parents() {
+        parentMap.clear();
+        return parentMap;
+    }
+
+    CompactParentTable& compact() {
+        compactTable.reset();
+        return compactTable;
+    }
+
+    Frontiers& frontiers() {
+        levels.current.clear();
+        levels.next.clear();
+        for (std::vector<State>& buffer : levels.buffers) buffer.clear();
+        return levels;
+    }
+
+    // `slotCount` slots ready for a solve of up to `iterations` iterations.
+    Transpositions& transpositions(size_t slotCount, uint64_t iterations) {
+        if (ida.slots.size() != slotCount || ida.iteration + iterations > MAX_ITERATION) {
+            ida.slots.assign(slotCount, 0);
+            ida.iteration = 0;
+        }
+        ida.path.clear();
+        return ida;
+    }
+
+private:
+    static constexpr uint64_t MAX_ITERATION = 0xFFFF;
+
+    bool hugePages;
+    PageResource pages;
+    std::pmr::unsynchronized_pool_resource nodes;
+    ParentMap parentMap;
+    std::unique_ptr<VisitedTable> table;
+    size_t tableBudget = 0;
+    CompactParentTable compactTable;
+    Frontiers levels;
+    Transpositions ida;
+};
+
+// Hands out arenas to concurrent solves. acquire() returns an idle arena, or
+// a new one, for as long as the lease lives. A worker that picks up another
+// solve while it waits inside a parallel one gets a second arena, so two
+// solves never share one.
+class SearchArenaPool {
+public:
+    class Lease {
+    public:
+        Lease(SearchArenaPool& pool, std::unique_ptr<SearchArena> arena)
+            : pool(&pool), arena(std::move(arena)) {}
+        Lease(Lease&&) = default;
+        Lease& operator=(Lease&&) = delete;
+        ~Lease() {
+            if (arena) pool->release(std::move(arena));
+        }
+
+        SearchArena* get() const { return arena.get(); }
+        SearchArena& operator*() const { return *arena; }
+
+    private:
+        SearchArenaPool* pool;
+        std::unique_ptr<SearchArena> arena;
+    };
+
+    Lease acquire() {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (idle.empty()) return Lease(*this, std::make_unique<SearchArena>());
+        std::unique_ptr<SearchArena> arena = std::move(idle.back());
+        idle.pop_back();
+        return Lease(*this, std::move(arena));
+    }
+
+private:
+    void release(std::unique_ptr<SearchArena> arena) {
+        std::lock_guard<std::mutex> lock(mutex);
+        idle.push_back(std::move(arena));
+    }
+
+    std::mutex mutex;
+    std::vector<std::unique_ptr<SearchArena>> idle;
+};
+
+// Record of the external BFS: a state and how it was reached. `link` packs
+// the previous cell byte of the robot that moved (bits 0-7), the slot it
+// occupies in `state` (bits 8-10, 7 = root) and the direction index (11-12).
+struct LinkedState {
+    State state;
+    uint16_t link;
+
+    bool operator<(const LinkedState& other) const { return state < other.state; }
+};
+
+// Writes a sorted run of LinkedStates to disk, each as a varint of the gap
+// from the previous state followed by the two link bytes. Sorted 40-bit
+// states are dense, so most gaps fit in one to three bytes.
+class StateRunWriter {
+public:
+    explicit StateRunWriter(const std::filesystem::path& path)
+        : file(path, std::ios::binary | std::ios::trunc) {
+        if (!file.is_open()) {
+            throw std::runtime_error("Could not open file for writing: " + path.string());
+        }
+        buffer.reserve(BUFFER_BYTES);
+    }
+
+    ~StateRunWriter() {
+        if (file.is_open()) flush();
+    }
+
+    void write(const LinkedState& record) {
+        State gap = record.state - previous;
+        previous = record.state;
+        while (gap >= 0x80) {
+            buffer.push_back(static_cast<uint8_t>(gap | 0x80));
+            gap >>= 7;
+        }
+        buffer.push_back(static_cast<uint8_t>(gap));
+        buffer.push_back(static_cast<uint8_t>(record.link));
+        buffer.push_back(static_cast<uint8_t>(record.link >> 8));
+        if (buffer.size() >= BUFFER_BYTES) flush();
+        count++;
+    }
+
+    void close() {
+        flush();
+        file.close();
+        if (file.fail()) {
+            throw std::runtime_error("Failed writing external BFS run.");
+        }
+    }
+
+    uint64_t size() const { return count; }
+
+private:
+    static constexpr size_t BUFFER_BYTES = size_t{1} << 16;
+
+    void flush() {
+        file.write(reinterpret_cast<const char*>(buffer.data()), buffer.size());
+        buffer.clear();
+        if (!file) {
+            throw std::runtime_error("Failed writing external BFS run.");
+        }
+    }
+
+    std::ofstream file;
+    std::vector<uint8_t> buffer;
+    State previous = 0;
+    uint64_t count = 0;
+};
+
+class StateRunReader {
+public:
+    explicit StateRunReader(const std::filesystem::path& path)
+        : file(path, std::ios::binary), buffer(BUFFER_BYTES) {
+        if (!file.is_open()) {
+            throw std::runtime_error("Could not open file: " + path.string());
+        }
+        advance();
+    }
+
+    bool done() const { return exhausted; }
+    const LinkedState& current() const { return record; }
+
+    void advance() {
+        State gap = 0;
+        int c;
+        for (int shift = 0; ; shift += 7) {
+            if ((c = next()) < 0) {
+                if (shift != 0) throw std::runtime_error("Truncated external BFS run.");
+                exhausted = true;
+                return;
+            }
+            gap |= static_cast<State>(c & 0x7F) << shift;
+            if (!(c & 0x80)) break;
+        }
+        int lo = next();
+        int hi = next();
+        if (lo < 0 || hi < 0) throw std::runtime_error("Truncated external BFS run.");
+        record.state += gap;
+        record.link = static_cast<uint16_t>(lo | (hi << 8));
+    }
+
+private:
+    static constexpr size_t BUFFER_BYTES = size_t{1} << 16;
+
+    int next() {
+        if (pos == filled) {
+            file.read(reinterpret_cast<char*>(buffer.data()), buffer.size());
+            filled = static_cast<size_t>(file.gcount());
+            pos = 0;
+            if (filled == 0) return -1;
+        }
+        return buffer[pos++];
+    }
+
+    std::ifstream file;
+    std::vector<uint8_t> buffer;
+    size_t pos = 0;
+    size_t filled = 0;
+    LinkedState record{0, 0};
+    bool exhausted = false;
+};
+
+template <int Robots>
+class BasicSolver {
+public:
+    using Positions = std::array<std::pair<int, int>, Robots>;
+    static constexpr int MOVES = 4 * Robots;
+
+    BasicSolver(const CompiledBoard& board, State initial)
+        : BasicSolver(board, initial, board.getTargetRobot(), board.getTargetCell()) {}
+
+    // Solves for an explicit target instead of the one compiled into the
+    // board, so many puzzles can share one CompiledBoard.
+    BasicSolver(const CompiledBoard& board, State initial, int targetRobot, int targetCell)
+        : board(board), slides(board.getSlides()), initial(initial),
+          targetRobot(targetRobot), targetCell(targetCell)
+    {
+        if (targetRobot < 0 || targetRobot >= Robots) {
+            throw std::runtime_error("Target robot not set or invalid on the board before creating Solver.");
+        }
+        if (targetCell < 0 || targetCell >= board.getWidth() * board.getHeight()) {
+            throw std::runtime_error("Target cell is outside the board.");
+        }
+    }
+
+    static constexpr size_t DEFAULT_MEMORY_BUDGET = size_t{1} << 30;
+
+    // Treat helper robots whose colors no diagonal distinguishes as
+    // interchangeable: states are stored with those robots sorted by cell, and
+    // solutions are mapped back to the real robots afterwards. Applies to
+    // solve(), solve_sequential() and solve_ida().
+    void setCanonicalStates(bool enabled) {
+        symmetricRobots.clear();
+        if (!enabled) return;
+        for (int robot = 0; robot < Robots; ++robot) {
+            if (robot != targetRobot && !board.hasDiagonalColor(board.robotColorId(robot))) {
+                symmetricRobots.push_back(robot);
+            }
+        }
+        if (symmetricRobots.size() < 2) symmetricRobots.clear();
+    }
+
+    // Upper bound on the parallel solver's visited table, in bytes.
+    void setMemoryBudget(size_t bytes) { memoryBudget = bytes; }
+
+    // Store solve_sequential()'s visited set as a CompactParentTable, about 8
+    // to 16 bytes per state instead of a hash-map node holding the parent.
+    void setCompactParents(bool enabled) { compactParents = enabled; }
+
+    // Scratch directory and in-memory run size for solve_external().
+    void setExternalStorage(const std::filesystem::path& directory, size_t ramBytes) {
+        externalDirectory = directory;
+        externalRam = ramBytes;
+    }
+
+    // Take tables and buffers from `shared` instead of the solver's own. The
+    // arena must outlive the solves and serve one solve at a time.
+    void setArena(SearchArena* shared) { arena = shared; }
+
+    const SearchStats& getStats() const { return stats; }
+
+    // Called on the solving thread after each level completes.
+    void setLevelCallback(std::function<void(const LevelStats&)> callback) {
+        levelCallback = std::move(callback);
+    }
+
+    // Cancels a search once it has run for `timeout` or expanded `maxExpanded`
+    // states; zero disables either limit. Checked every few thousand states.
+    void setLimits(std::chrono::milliseconds timeout, uint64_t maxExpanded) {
+        timeLimit = timeout;
+        nodeLimit = maxExpanded;
+    }
+
+    // Level-synchronous parallel BFS. Workers take contiguous chunks of the
+    // current frontier and append children to a thread-local buffer; at the
+    // level barrier the buffers are concatenated into the next frontier. All
+    // of these vectors keep their capacity from level to level, and from
+    // solve to solve when they come from an arena.
+    std::vector<Move> solve() {
+        SearchArena& scratch = scratchArena();
+        SearchArena::Frontiers& frontiers = scratch.frontiers();
+        std::vector<State>& current_level = frontiers.current;
+        std::vector<State>& next_level = frontiers.next;
+        auto& buffers = frontiers.buffers;
+        VisitedTable& visited = scratch.visited(memoryBudget);
+        std::vector<Move> solution;
+        State solution_state = 0;
+        State root = canonical(initial);
+        stats = {};
+        auto deadline = startClock();
+
+        current_level.push_back(root);
+        visited.insert(root, {-1, Direction::UP}, 0);
+        uint64_t stored = 1;
+
+        std::atomic<bool> solutionFound = false;
+        std::atomic<bool> cancelled = false;
+        std::atomic<uint64_t> expanded = 0;
+        if (checkSolution(root)) {
+            solutionFound = true;
+            solution_state = root;
+        } else {
+            stats.exhaustedDepth = 0;
+        }
+
+        for (int depth = 0; !solutionFound && !cancelled && !current_level.empty(); ++depth) {
+            auto level_start = std::chrono::steady_clock::now();
+            tbb::combinable<LevelCounters> counters;
+            // Cancelling the level stops chunks that have not started yet;
+            // running ones see the flags at their next state.
+            tbb::task_group_context level_context;
+
+            tbb::parallel_for(tbb::blocked_range<size_t>(0, current_level.size(), FRONTIER_GRAIN),
+                [&](const auto& r) {
+                    LevelCounters& local = counters.local();
+                    std::vector<State>& out = buffers.local();
+                    for (size_t i = r.begin(); i < r.end(); ++i) {
+                        if (solutionFound.load(std::memory_order_relaxed) ||
+                            cancelled.load(std::memory_order_relaxed)) return;
+                        if ((i & (LIMIT_CHECK_INTERVAL - 1)) == 0 &&
+                            overLimits(expanded.fetch_add(LIMIT_CHECK_INTERVAL, std::memory_order_relaxed), deadline)) {
+                            cancelled.store(true);
+                            level_context.cancel_group_execution();
+                            return;
+                        }
+
+                        const State& current = current_level[i];
+                        local.expanded++;
+
+                        bool timed = (i & (TIMING_SAMPLE - 1)) == 0;
+                        if (timed) local.sampled++;
+
+                        auto move_start = timed ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point{};
+                        std::array<Successor, MOVES> children;
+                        int count = successors(current, children);
+                        auto insert_start = timed ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point{};
+                        if (timed) local.moveTime += insert_start - move_start;
+
+                        for (int c = 0; c < count; ++c) {
+                            const Successor& child = children[c];
+                            State new_state = canonical(child.state);
+                            Move move{slotOf(new_state, child.robot, child.to()), child.dir};
+                            uint8_t from = static_cast<uint8_t>(current >> (8 * child.robot));
+
+                            auto inserted = visited.insert(new_state, move, from);
+                            if (inserted == VisitedTable::InsertResult::Inserted) {
+                                out.push_back(new_state);
+                                local.inserted++;
+                            } else if (inserted == VisitedTable::InsertResult::Present) {
+                                local.duplicates++;
+                                continue;
+                            } else {
+                                throw std::runtime_error("Visited table exceeded its memory budget.");
+                            }
+
+                            // Only the thread that inserted a goal state claims it, so
+                            // its parent entry is the one reconstruction will follow.
+                            bool expected = false;
+                            if (reachesTarget(child) && solutionFound.compare_exchange_strong(expected, true)) {
+                                solution_state = new_state;
+                                level_context.cancel_group_execution();
+                                return;
+                            }
+                        }
+                        if (timed) local.insertTime += std::chrono::steady_clock::now() - insert_start;
+                    }
+                }, level_context);
+
+            next_level.clear();
+            size_t buffered = 0;
+            for (std::vector<State>& buffer : buffers) {
+                if (!solutionFound && !cancelled) next_level.insert(next_level.end(), buffer.begin(), buffer.end());
+                buffered += buffer.capacity();
+                buffer.clear();
+            }
+
+            LevelCounters level;
+            counters.combine_each([&level](const LevelCounters& c) { level.add(c); });
+            stored += level.inserted;
+            finishLevel(level, depth, current_level.size(),
+                        static_cast<double>(stored) / visited.getCapacity(),
+                        visited.getCapacity() * sizeof(uint64_t) +
+                            (current_level.capacity() + next_level.capacity() + buffered) * sizeof(State),
+                        level_start);
+            if (!solutionFound && !cancelled) stats.exhaustedDepth = depth + 1;
+            current_level.swap(next_level);
+        }
+
+        stats.cancelled = cancelled && !solutionFound;
+        if (solutionFound) {
+            solution = relabel(reconstructPath(visited, solution_state));
+        }
+
+        return solution;
+    }
+
+    std::vector<Move> solve_sequential() {
+        SearchArena& scratch = scratchArena();
+        SearchArena::Frontiers& frontiers = scratch.frontiers();
+        std::vector<State>& level_states = frontiers.current;
+        std::vector<State>& next_states = frontiers.next;
+        SearchArena::ParentMap& visited = scratch.parents();
+        CompactParentTable& compact = scratch.compact();
+        std::vector<Move> solution;
+        State solution_state = 0;
+        bool solutionFound = false; 
+        State root = canonical(initial);
+        stats = {};
+        auto deadline = startClock();
+
+        level_states.push_back(root);
+        if (compactParents) {
+            compact.insert(root, -1, Direction::UP, 0);
+        } else {
+            visited[root] = {root, {-1, Direction::UP}}; 
+        }
+        if (checkSolution(root)) {
+            solution_state = root;
+            solutionFound = true;
+        } else {
+            stats.exhaustedDepth = 0;
+        }
+
+        for (int depth = 0; !solutionFound && !stats.cancelled && !level_states.empty(); ++depth) {
+            auto level_start = std::chrono::steady_clock::now();
+            size_t level_size = level_states.size();
+            LevelCounters level;
+            next_states.clear();
+            for (size_t i = 0; i < level_size; ++i) {
+                if ((i & (LIMIT_CHECK_INTERVAL - 1)) == 0 && overLimits(stats.expanded + level.expanded, deadline)) {
+                    stats.cancelled = true;
+                    break;
+                }
+                State current = level_states[i];
+                level.expanded++;
+
+                bool timed = (i & (TIMING_SAMPLE - 1)) == 0;
+                if (timed) level.sampled++;
+
+                auto move_start = timed ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point{};
+                std::array<Successor, MOVES> children;
+                int count = successors(current, children);
+                auto insert_start = timed ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point{};
+                if (timed) level.moveTime += insert_start - move_start;
+
+                for (int c = 0; c < count; ++c) {
+                    State new_state = canonical(children[c].state);
+                    Move move{children[c].robot, children[c].dir};
+
+                    bool inserted = compactParents
+                        ? compact.insert(new_state, slotOf(new_state, move.robot, children[c].to()), move.dir, depth + 1)
+                        : visited.emplace(new_state, std::make_pair(current, move)).second;
+                    if (inserted) {
+                        next_states.push_back(new_state); 
+                        level.inserted++;
+                        if (reachesTarget(children[c])) {
+                            solution_state = new_state;
+                            solutionFound = true;
+                            break;
+                        }
+                    } else {
+                        level.duplicates++;
+                    }
+                }
+                if (timed) level.insertTime += std::chrono::steady_clock::now() - insert_start;
+                if (solutionFound) break;
+            }
+            size_t frontierBytes = (level_states.capacity() + next_states.capacity()) * sizeof(State);
+            if (compactParents) {
+                finishLevel(level, depth, level_size, compact.loadFactor(), compact.bytes() + frontierBytes, level_start);
+            } else {
+                finishLevel(level, depth, level_size, visited.load_factor(),
+                            visited.size() * SEQUENTIAL_NODE_BYTES + visited.bucket_count() * sizeof(void*) + frontierBytes,
+                            level_start);
+            }
+            if (!solutionFound && !stats.cancelled) stats.exhaustedDepth = depth + 1;
+            level_states.swap(next_states);
+        }
+
+        if (solutionFound) {
+            solution = relabel(compactParents ? reconstructPathCompact(compact, solution_state)
+                                              : reconstructPathSequential(visited, solution_state));
+        }
+
+        return solution;
+    }
+
+    // One BFS from the initial state that records the first (shortest) hit
+    // for every goal and stops as soon as all are reached or maxDepth levels
+    // are expanded. Goals the search never reaches come back empty. Canonical
+    // states are not used here since the goals may name any robot. Honours
+    // setLimits(); after a cancelled search the goals already reached keep
+    // their (shortest) paths and stats.cancelled is set.
+    std::vector<std::optional<std::vector<Move>>> solve_goals(
+        const std::vector<Goal>& goals, int maxDepth = std::numeric_limits<int>::max()) {
+        const int cells = board.getWidth() * board.getHeight();
+        std::vector<std::vector<size_t>> waiting(Robots * cells);
+        for (size_t i = 0; i < goals.size(); ++i) {
+            waiting[goals[i].robot * cells + goals[i].cell].push_back(i);
+        }
+        size_t remaining = goals.size();
+        std::vector<std::optional<State>> hits(goals.size());
+
+        auto record = [&](State s) {
+            auto robots = decode<Robots>(s);
+            for (int r = 0; r < Robots; ++r) {
+                auto& list = waiting[r * cells + robots[r].second * board.getWidth() + robots[r].first];
+                for (size_t i : list) hits[i] = s;
+                remaining -= list.size();
+                list.clear();
+            }
+        };
+
+        SearchArena& scratch = scratchArena();
+        SearchArena::Frontiers& frontiers = scratch.frontiers();
+        SearchArena::ParentMap& visited = scratch.parents();
+        frontiers.current.push_back(initial);
+        visited[initial] = {initial, {-1, Direction::UP}};
+        record(initial);
+        stats = {};
+        stats.exhaustedDepth = 0;
+        auto deadline = startClock();
+
+        for (int depth = 0; depth < maxDepth && remaining > 0 && !stats.cancelled && !frontiers.current.empty(); ++depth) {
+            frontiers.next.clear();
+            for (size_t i = 0; i < frontiers.current.size() && remaining > 0; ++i) {
+                if ((stats.expanded & (LIMIT_CHECK_INTERVAL - 1)) == 0 && overLimits(stats.expanded, deadline)) {
+                    stats.cancelled = true;
+                    break;
+                }
+                stats.expanded++;
+                State current = frontiers.current[i];
+
+                std::array<Successor, MOVES> children;
+                int count = successors(current, children);
+                for (int c = 0; c < count && remaining > 0; ++c) {
+                    const Successor& child = children[c];
+                    if (visited.emplace(child.state, std::make_pair(current, Move{child.robot, child.dir})).second) {
+                        frontiers.next.push_back(child.state);
+                        record(child.state);
+                    }
+                }
+            }
+            if (!stats.cancelled && remaining > 0) stats.exhaustedDepth = depth + 1;
+            frontiers.current.swap(frontiers.next);
+        }
+
+        std::vector<std::optional<std::vector<Move>>> paths(goals.size());
+        for (size_t i = 0; i < goals.size(); ++i) {
+            if (hits[i]) paths[i] = reconstructPathSequential(visited, *hits[i]);
+        }
+        return paths;
+    }
+
+    // Level-synchronous BFS that keeps the visited set on disk. Children of
+    // each level are collected in memory up to the RAM cap, sorted and spilled
+    // as runs; the runs are merged, deduplicated and filtered against every
+    // earlier level (moves are not reversible, so any level can hold a repeat)
+    // to form the next level file. Each state carries its parent link, and the
+    // path is rebuilt by scanning the level files backwards.
+    std::vector<Move> solve_external() {
+        std::filesystem::path dir = externalDirectory.empty()
+            ? std::filesystem::temp_directory_path() : externalDirectory;
+        dir /= "rr_bfs_" + std::to_string(reinterpret_cast<uintptr_t>(this)) + "_" +
+               std::to_string(std::chrono::steady_clock::now().time_since_epoch().count());
+        std::filesystem::create_directories(dir);
+        struct Cleanup {
+            std::filesystem::path dir;
+            ~Cleanup() {
+                std::error_code ec;
+                std::filesystem::remove_all(dir, ec);
+            }
+        } cleanup{dir};
+
+        auto levelPath = [&dir](int depth) { return dir / ("level_" + std::to_string(depth) + ".rrx"); };
+        auto runPath = [&dir](size_t run) { return dir / ("run_" + std::to_string(run) + ".rrx"); };
+
+        stats = {};
+        auto deadline = startClock();
+        State root = canonical(initial);
+        {
+            StateRunWriter level0(levelPath(0));
+            level0.write({root, ROOT_LINK});
+            level0.close();
+        }
+        std::optional<State> goal;
+        if (checkSolution(root)) goal = root;
+
+        const size_t capacity = std::max<size_t>(externalRam / sizeof(LinkedState), 1024);
+        std::vector<LinkedState> buffer;
+        buffer.reserve(capacity);
+
+        int depth = 0;
+        for (uint64_t frontier = 1; !goal && frontier > 0; ++depth) {
+            auto level_start = std::chrono::steady_clock::now();
+            LevelCounters level;
+            uint64_t generated = 0;
+            size_t runs = 0;
+            auto spill = [&]() {
+                std::sort(buffer.begin(), buffer.end());
+                StateRunWriter run(runPath(runs++));
+                for (size_t i = 0; i < buffer.size(); ++i) {
+                    if (i == 0 || buffer[i].state != buffer[i - 1].state) run.write(buffer[i]);
+                }
+                run.close();
+                buffer.clear();
+            };
+
+            for (StateRunReader in(levelPath(depth)); !in.done(); in.advance()) {
+                if ((level.expanded & (LIMIT_CHECK_INTERVAL - 1)) == 0 &&
+                    overLimits(stats.expanded + level.expanded, deadline)) {
+                    stats.cancelled = true;
+                    return {};
+                }
+                level.expanded++;
+                State current = in.current().state;
+                std::array<Successor, MOVES> children;
+                int count = successors(current, children);
+                for (int c = 0; c < count; ++c) {
+                    State new_state = canonical(children[c].state);
+                    int slot = slotOf(new_state, children[c].robot, children[c].to());
+                    uint8_t from = static_cast<uint8_t>(current >> (8 * children[c].robot));
+                    buffer.push_back({new_state, packLink(slot, children[c].dir, from)});
+                    generated++;
+                    if (buffer.size() == capacity) spill();
+                }
+            }
+            if (!buffer.empty() || runs == 0) spill();
+
+            // Merge the runs, dropping states already in this or any earlier level.
+            std::vector<std::unique_ptr<StateRunReader>> inputs;
+            for (size_t r = 0; r < runs; ++r) inputs.push_back(std::make_unique<StateRunReader>(runPath(r)));
+            std::vector<std::unique_ptr<StateRunReader>> seen;
+            for (int d = 0; d <= depth; ++d) seen.push_back(std::make_unique<StateRunReader>(levelPath(d)));
+
+            auto later = [&inputs](size_t a, size_t b) {
+                return inputs[b]->current().state < inputs[a]->current().state;
+            };
+            std::priority_queue<size_t, std::vector<size_t>, decltype(later)> heap(later);
+            for (size_t r = 0; r < runs; ++r) {
+                if (!inputs[r]->done()) heap.push(r);
+            }
+
+            StateRunWriter out(levelPath(depth + 1));
+            std::optional<State> last;
+            while (!heap.empty()) {
+                size_t r = heap.top();
+                heap.pop();
+                LinkedState record = inputs[r]->current();
+                inputs[r]->advance();
+                if (!inputs[r]->done()) heap.push(r);
+
+                if (last && *last == record.state) continue;
+                last = record.state;
+
+                bool repeat = false;
+                for (auto& prior : seen) {
+                    while (!prior->done() && prior->current().state < record.state) prior->advance();
+                    if (!prior->done() && prior->current().state == record.state) repeat = true;
+                }
+                if (repeat) continue;
+
+                out.write(record);
+                if (!goal && checkSolution(record.state)) goal = record.state;
+            }
+            out.close();
+            inputs.clear();
+            for (size_t r = 0; r < runs; ++r) std::filesystem::remove(runPath(r));
+
+            frontier = out.size();
+            level.inserted = frontier;
+            level.duplicates = generated - frontier;
+            finishLevel(level, depth, level.expanded, 0, capacity * sizeof(LinkedState), level_start);
+            if (!goal) stats.exhaustedDepth = depth + 1;
+        }
+
+        if (!goal) return {};
+
+        std::vector<Move> path;
+        State current = *goal;
+        for (int d = depth; d > 0; --d) {
+            StateRunReader in(levelPath(d));
+            while (!in.done() && in.current().state < current) in.advance();
+            if (in.done() || in.current().state != current) {
+                throw std::logic_error("External BFS lost a state during path reconstruction.");
+            }
+            uint16_t link = in.current().link;
+            int slot = (link >> 8) & 0x7;
+            uint8_t from = static_cast<uint8_t>(link);
+            int shift = 8 * slot;
+            State prev = canonical((current & ~(State{0xFF} << shift)) | (State{from} << shift));
+            path.push_back({slotOf(prev, from), static_cast<Direction>(1 << ((link >> 11) & 0x3))});
+            current = prev;
+        }
+        std::reverse(path.begin(), path.end());
+        return relabel(path);
+    }
+
+    // Meet-in-the-middle search. The forward side is a plain BFS over full
+    // states. The backward side regresses from the goal over partial states:
+    // only robots that move or stop a slide in the suffix get a known cell,
+    // and `touched` collects every cell the suffix needs free of the others.
+    // Levels are grown on whichever side is currently smaller, and every new
+    // level is matched against everything seen on the other side, so the first
+    // meeting is an optimal solution.
+    std::vector<Move> solve_bidirectional() {
+        std::unordered_map<State, std::pair<State, Move>> forward;
+        std::vector<State> forwardLevel{initial};
+        forward[initial] = {initial, {-1, Direction::UP}};
+
+        BackNode root;
+        root.cells.fill(UNKNOWN_CELL);
+        root.cells[targetRobot] = static_cast<uint16_t>(targetCell);
+        root.touched = {};
+        setCell(root.touched, targetCell);
+        root.parent = -1;
+        root.move = {-1, Direction::UP};
+
+        std::vector<BackNode> backward{root};
+        BackNodeSet seenBackward(16, BackNodeHash{&backward}, BackNodeEqual{&backward});
+        seenBackward.insert(0);
+        size_t backwardLevelBegin = 0;
+        bool backwardOpen = true;
+
+        BackIndex index;
+        indexBackNodes(backward, 0, 1, index);
+
+        stats = {};
+        auto deadline = startClock();
+        State meetState = 0;
+        int meetNode = -1;
+        if (matchBackward(initial, backward, index, meetNode)) {
+            meetState = initial;
+        } else {
+            stats.exhaustedDepth = 0;
+        }
+        // Completed levels on each side; every pair of them has been matched,
+        // so without a meeting no solution of their combined length exists.
+        int forwardDepth = 0;
+        int backwardDepth = 0;
+
+        for (int step = 0; meetNode < 0 && !forwardLevel.empty(); ++step) {
+            if (overLimits(stats.expanded, deadline)) {
+                stats.cancelled = true;
+                return {};
+            }
+            auto level_start = std::chrono::steady_clock::now();
+            LevelCounters level;
+            size_t backwardLevelSize = backward.size() - backwardLevelBegin;
+            if (!backwardOpen || forwardLevel.size() <= backwardLevelSize) {
+                level.expanded = forwardLevel.size();
+                std::vector<State> next;
+                for (size_t i = 0; i < forwardLevel.size(); ++i) {
+                    if ((i & (LIMIT_CHECK_INTERVAL - 1)) == 0 && overLimits(stats.expanded + i, deadline)) {
+                        stats.cancelled = true;
+                        return {};
+                    }
+                    State current = forwardLevel[i];
+                    std::array<Successor, MOVES> children;
+                    int count = successors(current, children);
+                    for (int c = 0; c < count; ++c) {
+                        const Successor& child = children[c];
+                        if (forward.emplace(child.state, std::make_pair(current, Move{child.robot, child.dir})).second) {
+                            next.push_back(child.state);
+                            level.inserted++;
+                        } else {
+                            level.duplicates++;
+                        }
+                    }
+                }
+                forwardLevel.swap(next);
+                forwardDepth++;
+                for (State s : forwardLevel) {
+                    if (matchBackward(s, backward, index, meetNode)) {
+                        meetState = s;
+                        break;
+                    }
+                }
+            } else {
+                size_t levelEnd = backward.size();
+                level.expanded = levelEnd - backwardLevelBegin;
+                for (size_t i = backwardLevelBegin; i < levelEnd; ++i) {
+                    if ((i & (BACKWARD_CHECK_INTERVAL - 1)) == 0 &&
+                        overLimits(stats.expanded + (i - backwardLevelBegin), deadline)) {
+                        stats.cancelled = true;
+                        return {};
+                    }
+                    regress(backward, static_cast<int>(i), seenBackward);
+                }
+                level.inserted = backward.size() - levelEnd;
+                backwardLevelBegin = levelEnd;
+                backwardDepth++;
+                if (backward.size() == levelEnd ||
+                    backward.size() * sizeof(BackNode) > memoryBudget) {
+                    backwardOpen = false;
+                }
+
+                BackIndex levelIndex;
+                indexBackNodes(backward, levelEnd, backward.size(), levelIndex);
+                for (const auto& [s, parent] : forward) {
+                    if (matchBackward(s, backward, levelIndex, meetNode)) {
+                        meetState = s;
+                        break;
+                    }
+                }
+                for (auto& [key, ids] : levelIndex.buckets) {
+                    auto& bucket = index.buckets[key];
+                    bucket.insert(bucket.end(), ids.begin(), ids.end());
+                }
+                index.masks |= levelIndex.masks;
+            }
+            finishLevel(level, step, level.expanded, forward.load_factor(),
+                        forward.size() * SEQUENTIAL_NODE_BYTES + backward.capacity() * sizeof(BackNode),
+                        level_start);
+            if (meetNode < 0) stats.exhaustedDepth = forwardDepth + backwardDepth;
+        }
+
+        if (meetNode < 0) {
+            return {};
+        }
+
+        std::vector<Move> solution = reconstructPathSequential(forward, meetState);
+        State s = meetState;
+        for (int n = meetNode; backward[n].parent >= 0; n = backward[n].parent) {
+            const Move& move = backward[n].move;
+            auto robots = decode<Robots>(s);
+            auto [nx, ny] = simulateMove(robots[move.robot].first, robots[move.robot].second,
+                                         move.dir, robots, move.robot);
+            s = encode(robots, move.robot, nx, ny);
+            solution.push_back(move);
+        }
+        if (!checkSolution(s)) {
+            throw std::logic_error("Bidirectional search joined a path that misses the target.");
+        }
+        return solution;
+    }
+
+    static constexpr uint8_t UNREACHABLE = SlideTable::UNREACHABLE;
+    static constexpr int MAX_IDA_DEPTH = 64;
+    static constexpr size_t DEFAULT_TRANSPOSITION_SLOTS = size_t{1} << 22;
+
+    // Number of slots in the IDA* transposition table (8 bytes each).
+    void setTranspositionSlots(size_t slots) { transpositionSlots = slots; }
+
+    // Fewest moves for the target robot to reach the target from each cell,
+    // with the other robots ignored; see SlideTable::distancesTo.
+    std::vector<uint8_t> targetDistances(bool stopAnywhere) const {
+        return slides.distancesTo(targetCell, targetRobot, stopAnywhere);
+    }
+
+    // Iterative-deepening A* on the stop-anywhere target distances, with a
+    // fixed-size, always-replace transposition table so memory stays flat no
+    // matter how deep the search goes.
+    std::vector<Move> solve_ida() {
+        SearchArena::Transpositions& kept =
+            scratchArena().transpositions(std::max<size_t>(transpositionSlots, 1), MAX_IDA_DEPTH + 1);
+        IdaContext ctx{targetDistances(true), kept.slots, 0, kept.iteration, kept.path};
+        ctx.mask = ctx.table.size();
+        while (ctx.mask & (ctx.mask - 1)) ctx.mask &= ctx.mask - 1;
+        ctx.mask -= 1;
+
+        State root = canonical(initial);
+        stats = {};
+        int bound = heuristic(ctx, root);
+        if (bound == UNREACHABLE) {
+            stats.exhaustedDepth = MAX_IDA_DEPTH;
+            return {};
+        }
+
+        ctx.deadline = startClock();
+        while (bound <= MAX_IDA_DEPTH) {
+            ctx.iteration++;
+            auto iteration_start = std::chrono::steady_clock::now();
+            uint64_t before = stats.expanded;
+            int next = idaSearch(ctx, root, 0, bound);
+            LevelCounters level;
+            level.expanded = stats.expanded - before;
+            stats.expanded = before;
+            finishLevel(level, bound, level.expanded, 0, ctx.table.size() * sizeof(uint64_t), iteration_start);
+            if (ctx.cancelled) {
+                stats.cancelled = true;
+                return {};
+            }
+            if (next == IDA_FOUND) return relabel(ctx.path);
+            stats.exhaustedDepth = next == IDA_EXHAUSTED ? MAX_IDA_DEPTH : next - 1;
+            if (next == IDA_EXHAUSTED) return {};
+            bound = next;
+        }
+        // Only IDA_EXHAUSTED proves there is no solution; running past the
+        // depth cap is a cut-off like any other limit.
+        stats.cancelled = true;
+        return {};
+    }
+
+    // Staged search for puzzles that only need a few robots. Stage 0 moves
+    // the target robot alone, stage 1 the target plus each single helper, and
+    // stage 2 every robot. Each stage only looks for something shorter than
+    // the best solution so far and skips states whose depth plus the
+    // stop-anywhere lower bound reaches it; once a solution meets the lower
+    // bound of the start, it is optimal and the later stages are skipped.
+    // Canonical states are not used. LevelStats are reported per stage.
+    std::vector<Move> solve_staged() {
+        stats = {};
+        auto deadline = startClock();
+        if (checkSolution(initial)) return {};
+        std::vector<uint8_t> lower = targetDistances(true);
+        const int rootBound = lowerBound(lower, initial);
+        if (rootBound == UNREACHABLE) {
+            stats.exhaustedDepth = MAX_IDA_DEPTH;
+            return {};
+        }
+        stats.exhaustedDepth = rootBound - 1;
+
+        std::vector<Move> best;
+        int bound = std::numeric_limits<int>::max();
+        auto stage = [&](int number, uint32_t movable) {
+            if (bound == rootBound || stats.cancelled) return;
+            auto found = stagedSearch(number, movable, bound, lower, deadline);
+            if (found) {
+                best = std::move(*found);
+                bound = static_cast<int>(best.size());
+            }
+        };
+        stage(0, 1u << targetRobot);
+        for (int helper = 0; helper < Robots; ++helper) {
+            if (helper != targetRobot) stage(1, 1u << targetRobot | 1u << helper);
+        }
+        stage(2, ALL_ROBOTS);
+
+        if (stats.cancelled) return {};
+        if (!best.empty()) stats.exhaustedDepth = bound - 1;
+        return best;
+    }
+
+    std::vector<Move> reconstructPath(const VisitedTable& visited, State endState) const {
+
+        std::vector<Move> path;
+        State current = endState;
+        while (true) {
+            Move move;
+            uint8_t from;
+            if (!visited.find(current, move, from)) {
+                std::cerr << "Error: State " << current << " not found during parallel path reconstruction!" << std::endl; 
+                path.clear(); 
+                break;
+            }
+
+            if (move.robot == -1) { 
+                break;
+            }
+
+            int shift = 8 * move.robot;
+            State prev_state = canonical((current & ~(State{0xFF} << shift)) | (State{from} << shift));
+            path.push_back({slotOf(prev_state, from), move.dir});
+            if (current == prev_state) { 
+                std::cerr << "Error: Path reconstruction loop detected (parallel)! State " << current << " points to itself." << std::endl;
+                path.clear(); 
+                break;
+            }
+            current = prev_state;
+        }
+        std::reverse(path.begin(), path.end());
+        return path;
+    }
+
+    // Walks back level by level: the moved robot's predecessor cell is any
+    // reverse move in the recorded direction onto its current cell, with the
+    // other robots where they are, and the true parent is the candidate
+    // stored exactly one level up.
+    std::vector<Move> reconstructPathCompact(const CompactParentTable& visited, State endState) const {
+        const int width = board.getWidth();
+        std::vector<Move> path;
+        std::vector<SlideTable::Origin> arrived;
+        State current = endState;
+        uint64_t word = visited.find(current);
+        while (word != 0 && !CompactParentTable::isRoot(word)) {
+            int slot = CompactParentTable::slotOf(word);
+            Direction dir = CompactParentTable::direction(word);
+            uint8_t to = static_cast<uint8_t>(current >> (8 * slot));
+            int cell = (to >> 4) * width + (to & 0x0F);
+            int shift = 8 * slot;
+
+            std::array<uint64_t, 4> others{};
+            auto robots = decode<Robots>(current);
+            for (int r = 0; r < Robots; ++r) {
+                if (r != slot) setCell(others, robots[r].second * width + robots[r].first);
+            }
+            slides.arrivals(cell, slot, others, arrived);
+
+            uint64_t parentWord = 0;
+            for (const SlideTable::Origin& o : arrived) {
+                if (static_cast<Direction>(1 << o.dir) != dir) continue;
+                uint8_t from = static_cast<uint8_t>((o.start % width) | ((o.start / width) << 4));
+                State prev = canonical((current & ~(State{0xFF} << shift)) | (State{from} << shift));
+                uint64_t candidate = visited.find(prev);
+                if (candidate == 0 || CompactParentTable::depth(candidate) + 1 != CompactParentTable::depth(word)) continue;
+                path.push_back({slotOf(prev, from), dir});
+                current = prev;
+                parentWord = candidate;
+                break;
+            }
+            if (parentWord == 0) {
+                std::cerr << "Error: No parent found for state " << current << " during compact path reconstruction!" << std::endl;
+                path.clear();
+                break;
+            }
+            word = parentWord;
+        }
+        std::reverse(path.begin(), path.end());
+        return path;
+    }
+
+    template <typename ParentMap>
+    std::vector<Move> reconstructPathSequential(const ParentMap& visited, State endState) const {
+
+        std::vector<Move> path;
+        State current = endState;
+        while (true) {
+            auto it = visited.find(current);
+            if (it == visited.end()) {
+                 std::cerr << "Error: State " << current << " not found during sequential path reconstruction!" << std::endl;
+                 path.clear(); 
+                 break;
+            }
+            const auto& [prev_state, move] = it->second;
+
+            if (move.robot == -1) { 
+                break;
+            }
+
+            path.push_back(move);
+
+            if (current == prev_state) { 
+                std::cerr << "Error: Path reconstruction loop detected (sequential)! State " << current << " points to itself." << std::endl;
+                 path.clear(); 
+                 break;
+            }
+            current = prev_state;
+        }
+        std::reverse(path.begin(), path.end());
+        return path;
+    }
+
+private:
+    State encode(const Positions& current_robots,
+                 int robot_to_move, int next_x, int next_y) const {
+        auto temp_robots = current_robots;
+        temp_robots[robot_to_move] = {next_x, next_y};
+        return ::encode(temp_robots);
+    }
+
+    std::pair<int, int> simulateMove(int start_x, int start_y, Direction initial_dir,
+                                     const Positions& current_robots,
+                                     int moving_robot_index) const {
+        Occupancy occ = occupancy(current_robots);
+        int stop = slideStop(occ, start_x, start_y, initial_dir, moving_robot_index);
+        return {stop % board.getWidth(), stop / board.getWidth()};
+    }
+
+    // Every (robot, direction) move of `s` that changes the state, robot-major
+    // in UP, DOWN, LEFT, RIGHT order, for the robots whose bits are set in
+    // `movable`; the others hold still. Builds the occupancy masks once for
+    // all the moves.
+    int successors(State s, std::array<Successor, MOVES>& out, uint32_t movable = ALL_ROBOTS) const {
+        auto robots = decode<Robots>(s);
+        Occupancy occ = occupancy(robots);
+        const int width = board.getWidth();
+        int count = 0;
+        for (int robot = 0; robot < Robots; ++robot) {
+            if (!(movable >> robot & 1)) continue;
+            auto [x, y] = robots[robot];
+            int start = y * width + x;
+            int shift = 8 * robot;
+            for (Direction dir : {Direction::UP, Direction::DOWN,
+                                 Direction::LEFT, Direction::RIGHT}) {
+                int stop = slideStop(occ, x, y, dir, robot);
+                if (stop == start) continue;
+                State byte = static_cast<State>((stop % width) | ((stop / width) << 4));
+                out[count++] = {(s & ~(State{0xFF} << shift)) | (byte << shift), robot, dir};
+            }
+        }
+        return count;
+    }
+
+    static constexpr int IDA_FOUND = -1;
+    static constexpr int IDA_EXHAUSTED = std::numeric_limits<int>::max();
+
+    // Transposition slots hold state (bits 0-39), depth (40-47) and the
+    // iteration that wrote them (48-63), so no clearing between iterations.
+    // The table, iteration counter and path live in the solver's arena.
+    struct IdaContext {
+        std::vector<uint8_t> distances;
+        std::vector<uint64_t>& table;
+        size_t mask;
+        uint64_t& iteration;
+        std::vector<Move>& path;
+        std::chrono::steady_clock::time_point deadline{};
+        bool cancelled = false;
+    };
+
+    static constexpr uint32_t ALL_ROBOTS = (1u << Robots) - 1;
+
+    int lowerBound(const std::vector<uint8_t>& distances, State s) const {
+        State byte = (s >> (8 * targetRobot)) & 0xFF;
+        return distances[(byte >> 4) * board.getWidth() + (byte & 0x0F)];
+    }
+
+    // One solve_staged() stage: BFS over the `movable` robots for a solution
+    // of fewer than `bound` moves. A full stage that finds nothing proves the
+    // bound optimal, so it also records the exhausted depth.
+    std::optional<std::vector<Move>> stagedSearch(int number, uint32_t movable, int bound,
+                                                  const std::vector<uint8_t>& lower,
+                                                  std::chrono::steady_clock::time_point deadline) {
+        auto stage_start = std::chrono::steady_clock::now();
+        SearchArena& scratch = scratchArena();
+        SearchArena::ParentMap& visited = scratch.parents();
+        SearchArena::Frontiers& frontiers = scratch.frontiers();
+        std::vector<State>& level = frontiers.current;
+        std::vector<State>& next = frontiers.next;
+        level.push_back(initial);
+        visited[initial] = {initial, {-1, Direction::UP}};
+        LevelCounters counters;
+        std::optional<State> goal;
+
+        for (int depth = 0; !goal && !stats.cancelled && !level.empty() && depth + 1 < bound; ++depth) {
+            next.clear();
+            for (State current : level) {
+                if ((counters.expanded & (LIMIT_CHECK_INTERVAL - 1)) == 0 &&
+                    overLimits(stats.expanded + counters.expanded, deadline)) {
+                    stats.cancelled = true;
+                    break;
+                }
+                counters.expanded++;
+                std::array<Successor, MOVES> children;
+                int count = successors(current, children, movable);
+                for (int c = 0; c < count; ++c) {
+                    const Successor& child = children[c];
+                    if (depth + 1 + lowerBound(lower, child.state) >= bound) continue;
+                    if (!visited.emplace(child.state, std::make_pair(current, Move{child.robot, child.dir})).second) {
+                        counters.duplicates++;
+                        continue;
+                    }
+                    counters.inserted++;
+                    if (reachesTarget(child)) {
+                        goal = child.state;
+                        break;
+                    }
+                    next.push_back(child.state);
+                }
+                if (goal) break;
+            }
+            level.swap(next);
+            if (movable == ALL_ROBOTS && !goal && !stats.cancelled) stats.exhaustedDepth = std::max(stats.exhaustedDepth, depth + 1);
+        }
+
+        finishLevel(counters, number, counters.expanded, visited.load_factor(),
+                    visited.size() * SEQUENTIAL_NODE_BYTES + visited.bucket_count() * sizeof(void*), stage_start);
+        if (!goal || stats.cancelled) return std::nullopt;
+        return reconstructPathSequential(visited, *goal);
+    }
+
+    int heuristic(const IdaContext& ctx, State s) const {
+        State byte = (s >> (8 * targetRobot)) & 0xFF;
+        return ctx.distances[(byte >> 4) * board.getWidth() + (byte & 0x0F)];
+    }
+
+    int idaSearch(IdaContext& ctx, State s, int g, int bound) {
+        if (ctx.cancelled) return IDA_EXHAUSTED;
+        int h = heuristic(ctx, s);
+        if (h == UNREACHABLE) return IDA_EXHAUSTED;
+        if (g + h > bound) return g + h;
+        if (checkSolution(s)) return IDA_FOUND;
+
+        uint64_t& slot = ctx.table[(s * 0x9E3779B97F4A7C15ull >> 20) & ctx.mask];
+        if ((slot & ((uint64_t{1} << 40) - 1)) == s && (slot >> 48) == ctx.iteration) {
+            if (static_cast<int>((slot >> 40) & 0xFF) <= g) return IDA_EXHAUSTED;
+        }
+        slot = s | (static_cast<uint64_t>(g) << 40) | (ctx.iteration << 48);
+        if ((++stats.expanded & (LIMIT_CHECK_INTERVAL - 1)) == 0 && overLimits(stats.expanded, ctx.deadline)) {
+            ctx.cancelled = true;
+            return IDA_EXHAUSTED;
+        }
+
+        int next = IDA_EXHAUSTED;
+        std::array<Successor, MOVES> children;
+        int count = successors(s, children);
+        // Children come out robot-major; try the target robot's moves first.
+        int first = 0;
+        while (first < count && children[first].robot < targetRobot) first++;
+        for (int i = 0; i < count; ++i) {
+            const Successor& child = children[(first + i) % count];
+            ctx.path.push_back({child.robot, child.dir});
+            int t = idaSearch(ctx, canonical(child.state), g + 1, bound);
+            if (t == IDA_FOUND) return IDA_FOUND;
+            ctx.path.pop_back();
+            next = std::min(next, t);
+        }
+        return next;
+    }
+
+    static constexpr uint16_t UNKNOWN_CELL = 0xFFFF;
+
+    // Backward search node; `move` leads from this node to `parent`.
+    struct BackNode {
+        std::array<uint16_t, Robots> cells;
+        std::array<uint64_t, 4> touched;
+        int parent;
+        Move move;
+    };
+
+    struct BackNodeHash {
+        const std::vector<BackNode>* nodes;
+        size_t operator()(int i) const {
+            const BackNode& n = (*nodes)[i];
+            uint64_t h = 0;
+            for (uint16_t c : n.cells) h = h * 257 + c;
+            for (uint64_t w : n.touched) h = (h ^ w) * 0x9E3779B97F4A7C15ull;
+            return static_cast<size_t>(h ^ (h >> 32));
+        }
+    };
+
+    struct BackNodeEqual {
+        const std::vector<BackNode>* nodes;
+        bool operator()(int a, int b) const {
+            const BackNode& x = (*nodes)[a];
+            const BackNode& y = (*nodes)[b];
+            return x.cells == y.cells && x.touched == y.touched;
+        }
+    };
+
+    using BackNodeSet = std::unordered_set<int, BackNodeHash, BackNodeEqual>;
+
+    // Backward nodes bucketed by which robots they pin and where.
+    struct BackIndex {
+        std::unordered_map<uint64_t, std::vector<int>> buckets;
+        uint32_t masks = 0;
+    };
+
+    static bool hasCell(const std::array<uint64_t, 4>& bits, int cell) {
+        return (bits[cell >> 6] >> (cell & 63)) & 1;
+    }
+
+    static void setCell(std::array<uint64_t, 4>& bits, int cell) {
+        bits[cell >> 6] |= uint64_t{1} << (cell & 63);
+    }
+
+    static uint64_t backKey(uint32_t mask, const std::array<int, Robots>& cells) {
+        uint64_t key = static_cast<uint64_t>(mask) << 40;
+        for (int r = 0; r < Robots; ++r) {
+            if (mask & (1u << r)) key |= static_cast<uint64_t>(cells[r]) << (8 * r);
+        }
+        return key;
+    }
+
+    static uint32_t knownMask(const BackNode& n) {
+        uint32_t mask = 0;
+        for (int r = 0; r < Robots; ++r) {
+            if (n.cells[r] != UNKNOWN_CELL) mask |= 1u << r;
+        }
+        return mask;
+    }
+
+    void indexBackNodes(const std::vector<BackNode>& nodes, size_t begin, size_t end,
+                        BackIndex& index) const {
+        for (size_t i = begin; i < end; ++i) {
+            std::array<int, Robots> cells;
+            for (int r = 0; r < Robots; ++r) cells[r] = nodes[i].cells[r];
+            uint32_t mask = knownMask(nodes[i]);
+            index.buckets[backKey(mask, cells)].push_back(static_cast<int>(i));
+            index.masks |= 1u << mask;
+        }
+    }
+
+    bool matchBackward(State s, const std::vector<BackNode>& nodes, const BackIndex& index,
+                       int& match) const {
+        std::array<int, Robots> cells;
+        auto robots = decode<Robots>(s);
+        for (int r = 0; r < Robots; ++r) cells[r] = robots[r].second * board.getWidth() + robots[r].first;
+
+        for (uint32_t mask = 0; mask < (1u << Robots); ++mask) {
+            if (!(index.masks & (1u << mask))) continue;
+            auto it = index.buckets.find(backKey(mask, cells));
+            if (it == index.buckets.end()) continue;
+            for (int id : it->second) {
+                bool free = true;
+                for (int r = 0; r < Robots && free; ++r) {
+                    if (!(mask & (1u << r)) && hasCell(nodes[id].touched, cells[r])) free = false;
+                }
+                if (free) {
+                    match = id;
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+
+    int knownRobotAt(const BackNode& n, int cell, int except) const {
+        for (int r = 0; r < Robots; ++r) {
+            if (r != except && n.cells[r] == cell) return r;
+        }
+        return -1;
+    }
+
+    // Appends every predecessor of nodes[idx]. A robot with a known cell can
+    // arrive there by any slide through that cell that stops on it; a robot
+    // the suffix never used is only worth moving if it leaves a touched cell,
+    // since otherwise dropping the move gives a shorter solution.
+    void regress(std::vector<BackNode>& nodes, int idx, BackNodeSet& seen) const {
+        const BackNode node = nodes[idx];
+
+        auto finish = [&](int robot, int start, int dir, const SlideTable::Entry& entry,
+                          const uint8_t* path, int step, const std::array<uint64_t, 4>& touched) {
+            BackNode child = node;
+            child.cells[robot] = static_cast<uint16_t>(start);
+            child.touched = touched;
+            child.parent = idx;
+            child.move = {robot, static_cast<Direction>(1 << dir)};
+
+            auto emit = [&](const BackNode& n) {
+                nodes.push_back(n);
+                if (!seen.insert(static_cast<int>(nodes.size() - 1)).second) nodes.pop_back();
+            };
+
+            if (step + 1 == entry.length) {
+                if (!entry.cyclic) emit(child);
+                return;
+            }
+            // The start cell is empty once the robot leaves it, so a slide
+            // that comes back onto it cannot stop against it.
+            int blocker = path[step + 1];
+            if (blocker == start) return;
+            if (knownRobotAt(node, blocker, robot) >= 0) {
+                emit(child);
+                return;
+            }
+            if (hasCell(touched, blocker)) return;
+            setCell(child.touched, blocker);
+            for (int r = 0; r < Robots; ++r) {
+                if (child.cells[r] != UNKNOWN_CELL) continue;
+                BackNode pinned = child;
+                pinned.cells[r] = static_cast<uint16_t>(blocker);
+                emit(pinned);
+            }
+        };
+
+        for (int robot = 0; robot < Robots; ++robot) {
+            if (node.cells[robot] != UNKNOWN_CELL) {
+                int end = node.cells[robot];
+                auto [first, last] = slides.origins(end, robot);
+                for (const SlideTable::Origin* o = first; o != last; ++o) {
+                    int start = o->start;
+                    if (start == end || knownRobotAt(node, start, robot) >= 0) continue;
+
+                    const SlideTable::Entry& entry = slides.entry(start, static_cast<Direction>(1 << o->dir), robot);
+                    const uint8_t* path = slides.path(entry);
+                    auto touched = node.touched;
+                    setCell(touched, start);
+                    bool clear = true;
+                    for (int k = 0; k <= o->step && clear; ++k) {
+                        if (knownRobotAt(node, path[k], robot) >= 0) clear = false;
+                        setCell(touched, path[k]);
+                    }
+                    if (clear) finish(robot, start, o->dir, entry, path, o->step, touched);
+                }
+            } else {
+                for (int start = 0; start < board.getWidth() * board.getHeight(); ++start) {
+                    if (!hasCell(node.touched, start) || knownRobotAt(node, start, robot) >= 0) continue;
+                    for (int dir = 0; dir < 4; ++dir) {
+                        const SlideTable::Entry& entry = slides.entry(start, static_cast<Direction>(1 << dir), robot);
+                        const uint8_t* path = slides.path(entry);
+                        auto touched = node.touched;
+                        setCell(touched, start);
+                        for (int k = 0; k < entry.length; ++k) {
+                            int cell = path[k];
+                            if (knownRobotAt(node, cell, robot) >= 0) break;
+                            setCell(touched, cell);
+                            if (cell == start || hasCell(node.touched, cell)) continue;
+                            finish(robot, start, dir, entry, path, k, touched);
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    static constexpr size_t TIMING_SAMPLE = 64;
+    static constexpr uint16_t ROOT_LINK = 7 << 8;
+    static constexpr size_t DEFAULT_EXTERNAL_RAM = size_t{256} << 20;
+
+    static uint16_t packLink(int slot, Direction dir, uint8_t from) {
+        return static_cast<uint16_t>(from | (slot << 8) | (dirToIndex(dir) << 11));
+    }
+    // Smallest frontier chunk a parallel worker takes; TBB splits larger
+    // ranges down to this and idle workers steal the remaining halves.
+    static constexpr size_t FRONTIER_GRAIN = 256;
+    static constexpr size_t LIMIT_CHECK_INTERVAL = 4096;
+    // Regressing one backward node can cost as much as thousands of forward expansions.
+    static constexpr size_t BACKWARD_CHECK_INTERVAL = 16;
+    // Rough per-entry cost of a node-based unordered_map<State, pair<State, Move>>.
+    static constexpr size_t SEQUENTIAL_NODE_BYTES = 48;
+
+    struct LevelCounters {
+        uint64_t expanded = 0;
+        uint64_t inserted = 0;
+        uint64_t duplicates = 0;
+        uint64_t sampled = 0;
+        std::chrono::steady_clock::duration moveTime{0};
+        std::chrono::steady_clock::duration insertTime{0};
+
+        void add(const LevelCounters& other) {
+            expanded += other.expanded;
+            inserted += other.inserted;
+            duplicates += other.duplicates;
+            sampled += other.sampled;
+            moveTime += other.moveTime;
+            insertTime += other.insertTime;
+        }
+    };
+
+    // The shared arena, or the solver's own one on plain pages, created on
+    // first use and kept for the solver's lifetime.
+    SearchArena& scratchArena() {
+        if (arena) return *arena;
+        if (!ownArena) ownArena = std::make_unique<SearchArena>(false);
+        return *ownArena;
+    }
+
+    static double secondsSince(std::chrono::steady_clock::time_point start) {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    // Returns the deadline for this solve; time_point::max() when unlimited.
+    std::chrono::steady_clock::time_point startClock() const {
+        if (timeLimit.count() == 0) return std::chrono::steady_clock::time_point::max();
+        return std::chrono::steady_clock::now() + timeLimit;
+    }
+
+    bool overLimits(uint64_t expanded, std::chrono::steady_clock::time_point deadline) const {
+        return (nodeLimit != 0 && expanded >= nodeLimit) || std::chrono::steady_clock::now() >= deadline;
+    }
+
+    void finishLevel(const LevelCounters& counters, int depth, uint64_t frontier, double loadFactor,
+                     size_t bytes, std::chrono::steady_clock::time_point start) {
+        double scale = counters.sampled ? static_cast<double>(counters.expanded) / counters.sampled : 0.0;
+        LevelStats level;
+        level.depth = depth;
+        level.frontier = frontier;
+        level.inserted = counters.inserted;
+        level.duplicates = counters.duplicates;
+        level.loadFactor = loadFactor;
+        level.moveSeconds = std::chrono::duration<double>(counters.moveTime).count() * scale;
+        level.insertSeconds = std::chrono::duration<double>(counters.insertTime).count() * scale;
+        level.bytes = bytes;
+        level.seconds = secondsSince(start);
+        stats.expanded += counters.expanded;
+        stats.levels.push_back(level);
+        if (levelCallback) levelCallback(level);
+    }
+
+    State canonical(State s) const {
+        if (symmetricRobots.empty()) return s;
+        std::array<uint8_t, Robots - 1> bytes;
+        size_t n = symmetricRobots.size();
+        for (size_t i = 0; i < n; ++i) {
+            bytes[i] = static_cast<uint8_t>(s >> (8 * symmetricRobots[i]));
+        }
+        // At most four bytes, so a plain insertion sort.
+        for (size_t i = 1; i < n; ++i) {
+            uint8_t b = bytes[i];
+            size_t j = i;
+            for (; j > 0 && bytes[j - 1] > b; --j) bytes[j] = bytes[j - 1];
+            bytes[j] = b;
+        }
+        for (size_t i = 0; i < n; ++i) {
+            int shift = 8 * symmetricRobots[i];
+            s = (s & ~(State{0xFF} << shift)) | (State{bytes[i]} << shift);
+        }
+        return s;
+    }
+
+    // Robot positions of one state as bit masks: rows[y] has bit x set and
+    // cols[x] has bit y set for every occupied (x, y); cells is indexed by cell.
+    struct Occupancy {
+        std::array<uint16_t, 16> rows{};
+        std::array<uint16_t, 16> cols{};
+        std::array<uint64_t, 4> cells{};
+    };
+
+    Occupancy occupancy(const Positions& robots) const {
+        Occupancy occ;
+        for (const auto& [x, y] : robots) {
+            occ.rows[y] |= static_cast<uint16_t>(1u << x);
+            occ.cols[x] |= static_cast<uint16_t>(1u << y);
+            setCell(occ.cells, y * board.getWidth() + x);
+        }
+        return occ;
+    }
+
+    // Bits lo..hi inclusive.
+    static uint32_t spanMask(int lo, int hi) {
+        return ((uint32_t{2} << hi) - 1) & ~((uint32_t{1} << lo) - 1);
+    }
+
+    // Cell where `robot` stops sliding from (x, y). A straight slide covers a
+    // contiguous span of one row or column mask, so the nearest blocker is a
+    // single bit scan; deflected slides test one occupancy bit per step.
+    int slideStop(const Occupancy& occ, int x, int y, Direction dir, int robot) const {
+        const int width = board.getWidth();
+        const int start = y * width + x;
+        const SlideTable::Entry& entry = slides.entry(start, dir, robot);
+        if (entry.length == 0) return start;
+
+        if (entry.straight) {
+            const int n = entry.length;
+            uint32_t hit;
+            switch (dir) {
+                case Direction::RIGHT:
+                    hit = occ.rows[y] & spanMask(x + 1, x + n);
+                    return hit ? start + (__builtin_ctz(hit) - 1 - x) : start + n;
+                case Direction::LEFT:
+                    hit = occ.rows[y] & spanMask(x - n, x - 1);
+                    return hit ? start - (x - 1 - (31 - __builtin_clz(hit))) : start - n;
+                case Direction::DOWN:
+                    hit = occ.cols[x] & spanMask(y + 1, y + n);
+                    return hit ? start + (__builtin_ctz(hit) - 1 - y) * width : start + n * width;
+                case Direction::UP:
+                    hit = occ.cols[x] & spanMask(y - n, y - 1);
+                    return hit ? start - (y - 1 - (31 - __builtin_clz(hit))) * width : start - n * width;
+            }
+        }
+
+        // The moving robot has left its start cell, so a ricochet that
+        // crosses it passes straight through.
+        const uint8_t* path = slides.path(entry);
+        int stop = start;
+        for (int k = 0; k < entry.length; ++k) {
+            if (path[k] != start && hasCell(occ.cells, path[k])) return stop;
+            stop = path[k];
+        }
+        return entry.cyclic ? start : stop;
+    }
+
+    static int slotOf(State s, uint8_t byte) {
+        for (int i = 0; i < Robots; ++i) {
+            if (static_cast<uint8_t>(s >> (8 * i)) == byte) return i;
+        }
+        return -1;
+    }
+
+    int slotOf(State s, int robot, uint8_t byte) const {
+        if (symmetricRobots.empty()) return robot;
+        return slotOf(s, byte);
+    }
+
+    // Maps a path over canonical states, whose moves name slots, back onto
+    // the real robots by replaying it from the initial positions.
+    std::vector<Move> relabel(std::vector<Move> path) const {
+        if (symmetricRobots.empty()) return path;
+        State real = initial;
+        for (Move& move : path) {
+            uint8_t byte = static_cast<uint8_t>(canonical(real) >> (8 * move.robot));
+            move.robot = slotOf(real, byte);
+            auto robots = decode<Robots>(real);
+            auto [nx, ny] = simulateMove(robots[move.robot].first, robots[move.robot].second,
+                                         move.dir, robots, move.robot);
+            real = encode(robots, move.robot, nx, ny);
+        }
+        return path;
+    }
+
+    bool checkSolution(State s) const {
+        auto pos = decode<Robots>(s)[targetRobot];
+        return pos.second * board.getWidth() + pos.first == targetCell;
+    }
+
+    // Only a move of the target robot can finish the puzzle, so a child is
+    // goal-tested with one compare when it is generated. The target robot is
+    // never relabelled by canonical(), so its slot is its index.
+    bool reachesTarget(const Successor& child) const {
+        return child.robot == targetRobot &&
+               child.to() == static_cast<uint8_t>((targetCell % board.getWidth()) | ((targetCell / board.getWidth()) << 4));
+    }
+
+    const CompiledBoard& board;
+    const SlideTable& slides;
+    State initial;
+    int targetRobot;
+    int targetCell;
+    size_t memoryBudget = DEFAULT_MEMORY_BUDGET;
+    size_t transpositionSlots = DEFAULT_TRANSPOSITION_SLOTS;
+    std::vector<int> symmetricRobots;
+    SearchStats stats;
+    std::function<void(const LevelStats&)> levelCallback;
+    std::chrono::milliseconds timeLimit{0};
+    uint64_t nodeLimit = 0;
+    bool compactParents = false;
+    std::filesystem::path externalDirectory;
+    size_t externalRam = DEFAULT_EXTERNAL_RAM;
+    SearchArena* arena = nullptr;
+    std::unique_ptr<SearchArena> ownArena;
+};
+
+using Solver = BasicSolver<5>;
+
+constexpr int MIN_ROBOTS = 3;
+constexpr int MAX_ROBOTS = 5;
+
+// Calls body(std::integral_constant<int, N>{}) for a runtime robot count N,
+// so callers can pick the BasicSolver<N> instance.
+template <typename Body>
+decltype(auto) withRobotCount(int robots, Body&& body) {
+    switch (robots) {
+        case 3: return body(std::integral_constant<int, 3>{});
+        case 4: return body(std::integral_constant<int, 4>{});
+        case 5: return body(std::integral_constant<int, 5>{});
+    }
+    throw std::invalid_argument("Robot count must be between " + std::to_string(MIN_ROBOTS) +
+                                " and " + std::to_string(MAX_ROBOTS));
+}
+
+// Shortest solution for every (robot, cell) pair from one starting position,
+// up to a fixed depth. Built by a single exhaustive BFS and saved to disk, so
+// later queries for the same board and start are a table lookup. Each entry
+// is a length byte (NOT_FOUND when not reachable within maxDepth) followed by
+// maxDepth move bytes of (robot << 2 | direction index).
+class DistanceDatabase {
+public:
+    static constexpr uint8_t NOT_FOUND = 0xFF;
+
+    static DistanceDatabase build(const CompiledBoard& board, State initial, int maxDepth) {
+        if (maxDepth < 1 || maxDepth >= NOT_FOUND) {
+            throw std::invalid_argument("Database depth must be between 1 and 254.");
+        }
+        DistanceDatabase db(board.fingerprint(), initial, board.getWidth() * board.getHeight(), maxDepth);
+        std::vector<Goal> goals;
+        for (int robot = 0; robot < 5; ++robot) {
+            for (int cell = 0; cell < db.cells; ++cell) goals.push_back({robot, cell});
+        }
+        Solver solver(board, initial, 0, 0);
+        auto paths = solver.solve_goals(goals, maxDepth);
+        for (size_t i = 0; i < goals.size(); ++i) {
+            if (!paths[i]) continue;
+            uint8_t* entry = db.entry(goals[i].robot, goals[i].cell);
+            entry[0] = static_cast<uint8_t>(paths[i]->size());
+            for (size_t k = 0; k < paths[i]->size(); ++k) {
+                const Move& move = (*paths[i])[k];
+                entry[1 + k] = static_cast<uint8_t>(move.robot << 2 | dirToIndex(move.dir));
+            }
+        }
+        return db;
+    }
+
+    // Rejects files written for a different layout or starting position.
+    static DistanceDatabase load(const std::string& filename, const CompiledBoard& board, State initial) {
+        std::ifstream file(filename, std::ios::binary);
+        if (!file.is_open()) {
+            throw std::runtime_error("Could not open file: " + filename);
+        }
+        Header header;
+        if (!file.read(reinterpret_cast<char*>(&header), sizeof(header)) ||
+            std::memcmp(header.magic, MAGIC, sizeof(header.magic)) != 0 || header.version != VERSION) {
+            throw std::runtime_error("Not a distance database: " + filename);
+        }
+        if (header.fingerprint != board.fingerprint() ||
+            header.cells != static_cast<uint32_t>(board.getWidth() * board.getHeight())) {
+            throw std::runtime_error("Distance database was built for a different board: " + filename);
+        }
+        if (header.initial != initial) {
+            throw std::runtime_error("Distance database was built for different robot positions: " + filename);
+        }
+        if (header.maxDepth < 1 || header.maxDepth >= NOT_FOUND) {
+            throw std::runtime_error("Corrupt distance database: " + filename);
+        }
+        DistanceDatabase db(header.fingerprint, header.initial, static_cast<int>(header.cells), header.maxDepth);
+        if (!file.read(reinterpret_cast<char*>(db.entries.data()), db.entries.size())) {
+            throw std::runtime_error("Truncated distance database: " + filename);
+        }
+        return db;
+    }
+
+    void save(const std::string& filename) const {
+        std::ofstream file(filename, std::ios::binary | std::ios::trunc);
+        if (!file.is_open()) {
+            throw std::runtime_error("Could not open file for writing: " + filename);
+        }
+        Header header{};
+        std::memcpy(header.magic, MAGIC, sizeof(header.magic));
+        header.version = VERSION;
+        header.maxDepth = static_cast<uint32_t>(maxDepth);
+        header.cells = static_cast<uint32_t>(cells);
+        header.fingerprint = fingerprint;
+        header.initial = initial;
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(reinterpret_cast<const char*>(entries.data()), entries.size());
+        if (!file) {
+            throw std::runtime_error("Failed writing distance database: " + filename);
+        }
+    }
+
+    int getMaxDepth() const { return maxDepth; }
+
+    // Minimum number of moves, or -1 if more than maxDepth are needed.
+    int distance(int robot, int cell) const {
+        uint8_t length = entry(robot, cell)[0];
+        return length == NOT_FOUND ? -1 : length;
+    }
+
+    std::optional<std::vector<Move>> lookup(int robot, int cell) const {
+        const uint8_t* e = entry(robot, cell);
+        if (e[0] == NOT_FOUND) return std::nullopt;
+        std::vector<Move> path;
+        for (int k = 0; k < e[0]; ++k) {
+            path.push_back({e[1 + k] >> 2, static_cast<Direction>(1 << (e[1 + k] & 0x3))});
+        }
+        return path;
+    }
+
+private:
+    static constexpr char MAGIC[4] = {'R', 'R', 'D', 'B'};
+    static constexpr uint32_t VERSION = 1;
+
+    struct Header {
+        char magic[4];
+        uint32_t version;
+        uint32_t maxDepth;
+        uint32_t cells;
+        uint64_t fingerprint;
+        State initial;
+    };
+
+    DistanceDatabase(uint64_t fingerprint, State initial, int cells, int maxDepth)
+        : fingerprint(fingerprint), initial(initial), cells(cells), maxDepth(maxDepth),
+          entries(static_cast<size_t>(5) * cells * (1 + maxDepth), 0) {
+        for (size_t i = 0; i < entries.size(); i += 1 + maxDepth) entries[i] = NOT_FOUND;
+    }
+
+    uint8_t* entry(int robot, int cell) {
+        return entries.data() + (static_cast<size_t>(robot) * cells + cell) * (1 + maxDepth);
+    }
+
+    const uint8_t* entry(int robot, int cell) const {
+        return entries.data() + (static_cast<size_t>(robot) * cells + cell) * (1 + maxDepth);
+    }
+
+    uint64_t fingerprint;
+    State initial;
+    int cells;
+    int maxDepth;
+    std::vector<uint8_t> entries;
+};
+
+// Solutions keyed by (board fingerprint, robot count, initial state, target),
+// held in an LRU bounded by an approximate byte budget. With a file the cache
+// also keeps an append-only log of every solution it learns: the file is
+// indexed on open and entries evicted from memory are read back from it.
+// A Solution of nullopt records a target proven unreachable; callers must
+// not insert the result of a cancelled search. Safe to share between threads.
+class SolutionCache {
+public:
+    struct Key {
+        uint64_t board;
+        State initial;
+        uint8_t robots;
+        uint8_t targetRobot;
+        uint8_t targetCell;
+
+        bool operator==(const Key& other) const {
+            return board == other.board && initial == other.initial && robots == other.robots &&
+                   targetRobot == other.targetRobot && targetCell == other.targetCell;
+        }
+    };
+
+    struct Stats {
+        uint64_t hits = 0;
+        uint64_t diskHits = 0;
+        uint64_t misses = 0;
+        uint64_t evictions = 0;
+        size_t entries = 0;
+        size_t bytes = 0;
+    };
+
+    using Solution = std::optional<std::vector<Move>>;
+
+    static constexpr size_t DEFAULT_MEMORY_BUDGET = size_t{64} << 20;
+
+    static Key key(const CompiledBoard& board, int robots, State initial, int targetRobot, int targetCell) {
+        return {board.fingerprint(), initial, static_cast<uint8_t>(robots),
+                static_cast<uint8_t>(targetRobot), static_cast<uint8_t>(targetCell)};
+    }
+
+    explicit SolutionCache(size_t memoryBudget = DEFAULT_MEMORY_BUDGET, const std::string& filename = "")
+        : budget(memoryBudget) {
+        if (!filename.empty()) openLog(filename);
+    }
+
+    std::optional<Solution> find(const Key& k) {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = index.find(k);
+        if (it != index.end()) {
+            lru.splice(lru.begin(), lru, it->second);
+            stats.hits++;
+            return it->second->second;
+        }
+        auto disk = offsets.find(k);
+        if (disk != offsets.end()) {
+            Solution moves = readLogMoves(disk->second);
+            stats.diskHits++;
+            remember(k, moves);
+            return moves;
+        }
+        stats.misses++;
+        return std::nullopt;
+    }
+
+    void insert(const Key& k, const Solution& moves) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (index.count(k)) return;
+        if (log.is_open() && !offsets.count(k)) appendLog(k, moves);
+        remember(k, moves);
+    }
+
+    Stats getStats() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return stats;
+    }
+
+private:
+    struct KeyHash {
+        size_t operator()(const Key& k) const {
+            uint64_t h = k.board ^ (k.initial * 0x9E3779B97F4A7C15ull);
+            h ^= (static_cast<uint64_t>(k.robots) << 16 | k.targetRobot << 8 | k.targetCell) * 0xC2B2AE3D27D4EB4Full;
+            return static_cast<size_t>(h ^ (h >> 31));
+        }
+    };
+
+    using Entry = std::pair<Key, Solution>;
+
+    // Rough cost of one entry: list node, hash node and the move vector.
+    static size_t entryBytes(const Solution& moves) {
+        return sizeof(Entry) + 4 * sizeof(void*) + (moves ? moves->size() * sizeof(Move) : 0);
+    }
+
+    void remember(const Key& k, const Solution& moves) {
+        lru.emplace_front(k, moves);
+        index[k] = lru.begin();
+        stats.bytes += entryBytes(moves);
+        while (stats.bytes > budget && lru.size() > 1) {
+            const Entry& victim = lru.back();
+            stats.bytes -= entryBytes(victim.second);
+            index.erase(victim.first);
+            lru.pop_back();
+            stats.evictions++;
+        }
+        stats.entries = lru.size();
+    }
+
+    // Log: magic "RRSC", then records of board (8), initial (8), robots,
+    // target robot, target cell, move count (NO_SOLUTION when unreachable),
+    // and one (robot << 2 | dir) byte per move. A torn record at the end is
+    // ignored and overwritten.
+    static constexpr char MAGIC[4] = {'R', 'R', 'S', 'C'};
+    static constexpr size_t RECORD_HEADER = 20;
+    static constexpr uint8_t NO_SOLUTION = 0xFF;
+
+    void openLog(const std::string& filename) {
+        {
+            std::ifstream in(filename, std::ios::binary);
+            std::vector<char> bytes;
+            if (in.is_open()) bytes.assign(std::istreambuf_iterator<char>(in), {});
+            size_t valid = 0;
+            if (bytes.size() >= sizeof(MAGIC)) {
+                if (std::memcmp(bytes.data(), MAGIC, sizeof(MAGIC)) != 0) {
+                    throw std::runtime_error("Not a solution cache: " + filename);
+                }
+                valid = sizeof(MAGIC);
+                while (valid + RECORD_HEADER <= bytes.size()) {
+                    const char* r = bytes.data() + valid;
+                    size_t length = static_cast<uint8_t>(r[19]);
+                    if (length == NO_SOLUTION) length = 0;
+                    if (valid + RECORD_HEADER + length > bytes.size()) break;
+                    Key k;
+                    std::memcpy(&k.board, r, 8);
+                    std::memcpy(&k.initial, r + 8, 8);
+                    k.robots = static_cast<uint8_t>(r[16]);
+                    k.targetRobot = static_cast<uint8_t>(r[17]);
+                    k.targetCell = static_cast<uint8_t>(r[18]);
+                    offsets[k] = valid;
+                    valid += RECORD_HEADER + length;
+                }
+            }
+            if (valid != bytes.size() || valid == 0) {
+                std::ofstream rewrite(filename, std::ios::binary | std::ios::trunc);
+                rewrite.write(MAGIC, sizeof(MAGIC));
+                if (valid > sizeof(MAGIC)) rewrite.write(bytes.data() + sizeof(MAGIC), valid - sizeof(MAGIC));
+                if (!rewrite) throw std::runtime_error("Could not write solution cache: " + filename);
+            }
+        }
+        log.open(filename, std::ios::binary | std::ios::in | std::ios::out | std::ios::app);
+        if (!log.is_open()) {
+            throw std::runtime_error("Could not open solution cache: " + filename);
+        }
+    }
+
+    void appendLog(const Key& k, const Solution& moves) {
+        if (moves && moves->size() >= NO_SOLUTION) return;
+        char r[RECORD_HEADER];
+        std::memcpy(r, &k.board, 8);
+        std::memcpy(r + 8, &k.initial, 8);
+        r[16] = static_cast<char>(k.robots);
+        r[17] = static_cast<char>(k.targetRobot);
+        r[18] = static_cast<char>(k.targetCell);
+        r[19] = static_cast<char>(moves ? moves->size() : NO_SOLUTION);
+        log.seekp(0, std::ios::end);
+        size_t offset = static_cast<size_t>(log.tellp());
+        log.write(r, sizeof(r));
+        for (const Move& move : moves ? *moves : std::vector<Move>{}) {
+            log.put(static_cast<char>(move.robot << 2 | dirToIndex(move.dir)));
+        }
+        log.flush();
+        if (!log) throw std::runtime_error("Failed writing solution cache.");
+        offsets[k] = offset;
+    }
+
+    Solution readLogMoves(size_t offset) {
+        char r[RECORD_HEADER];
+        log.seekg(static_cast<std::streamoff>(offset));
+        log.read(r, sizeof(r));
+        if (!log) throw std::runtime_error("Failed reading solution cache.");
+        if (static_cast<uint8_t>(r[19]) == NO_SOLUTION) return std::nullopt;
+        std::vector<Move> moves(static_cast<uint8_t>(r[19]));
+        for (Move& move : moves) {
+            int byte = log.get();
+            move = {byte >> 2, static_cast<Direction>(1 << (byte & 0x3))};
+        }
+        if (!log) throw std::runtime_error("Failed reading solution cache.");
+        return moves;
+    }
+
+    size_t budget;
+    std::list<Entry> lru;
+    std::unordered_map<Key, std::list<Entry>::iterator, KeyHash> index;
+    std::unordered_map<Key, size_t, KeyHash> offsets;
+    std::fstream log;
+    Stats stats;
+    mutable std::mutex mutex;
+};
+
+const std::unordered_map<int, std::vector<Direction>> wallMapping = {
+    {0,  {}},
+    {1,  {Direction::UP}},
+    {2,  {Direction::DOWN}}, 
+    {3,  {Direction::UP, Direction::DOWN}}, 
+    {4,  {Direction::LEFT}}, 
+    {5,  {Direction::UP, Direction::LEFT}}, 
+    {6,  {Direction::DOWN, Direction::LEFT}}, 
+    {7,  {Direction::UP, Direction::DOWN, Direction::LEFT}}, 
+    {8,  {Direction::RIGHT}}, 
+    {9,  {Direction::UP, Direction::RIGHT}}, 
+    {10, {Direction::DOWN, Direction::RIGHT}}, 
+    {11, {Direction::UP, Direction::DOWN, Direction::RIGHT}}, 
+    {12, {Direction::LEFT, Direction::RIGHT}}, 
+    {13, {Direction::UP, Direction::LEFT, Direction::RIGHT}}, 
+    {14, {Direction::DOWN, Direction::LEFT, Direction::RIGHT}}, 
+    {15, {Direction::UP, Direction::DOWN, Direction::LEFT, Direction::RIGHT}} 
+};
+
+// Openings follow the wall grid in text boards, one per line:
+//   opening <x> <y> <U|D|L|R>
+// Returns false for any other line, which the loaders ignore as before.
+bool parseOpening(const std::string& line, int& x, int& y, Direction& edge) {
+    std::istringstream iss(line);
+    std::string keyword;
+    char side = '?';
+    if (!(iss >> keyword) || keyword != "opening") return false;
+    if (!(iss >> x >> y >> side)) {
+        throw std::runtime_error("Malformed opening: " + line);
+    }
+    switch (std::toupper(static_cast<unsigned char>(side))) {
+        case 'U': edge = Direction::UP;    break;
+        case 'D': edge = Direction::DOWN;  break;
+        case 'L': edge = Direction::LEFT;  break;
+        case 'R': edge = Direction::RIGHT; break;
+        default: throw std::runtime_error("Malformed opening: " + line);
+    }
+    return true;
+}
+
+void loadFromFile(Board& board, const std::string& filename) {
+    std::ifstream file(filename);
+    if (!file.is_open()) {
+        throw std::runtime_error("Could not open file: " + filename);
+    }
+
+    std::string line;
+    int y = 0;
+    int boardHeight = board.getHeight();
+    int boardWidth = board.getWidth();
+
+    while (y < boardHeight && std::getline(file, line)) {
+        if (line.empty() || line[0] == '#') continue;
+
+        std::istringstream iss(line);
+        int x = 0;
+        int value;
+
+        while (iss >> value && x < boardWidth) {
+            if (value >= 0 && value <= 15) {
+                if (value & static_cast<int>(Direction::UP))    board.addWall(x, y, Direction::UP);
+                if (value & static_cast<int>(Direction::DOWN))  board.addWall(x, y, Direction::DOWN);
+                if (value & static_cast<int>(Direction::LEFT))  board.addWall(x, y, Direction::LEFT);
+                if (value & static_cast<int>(Direction::RIGHT)) board.addWall(x, y, Direction::RIGHT);
+            } else if (value >= 16 && value <= 25) {
                 char color = '?';
                 DiagonalOrientation orientation = DiagonalOrientation::NW_SE;
 
-                switch (value) {
-                    case 16: color = 'Y'; orientation = DiagonalOrientation::NW_SE; break;
-                    case 17: color = 'Y'; orientation = DiagonalOrientation::NE_SW; break;
-                    case 18: color = 'R'; orientation = DiagonalOrientation::NW_SE; break;
-                    case 19: color = 'R'; orientation = DiagonalOrientation::NE_SW; break;
-                    case 20: color = 'B'; orientation = DiagonalOrientation::NW_SE; break;
-                    case 21: color = 'B'; orientation = DiagonalOrientation::NE_SW; break;
-                    case 22: color = 'G'; orientation = DiagonalOrientation::NW_SE; break;
-                    case 23: color = 'G'; orientation = DiagonalOrientation::NE_SW; break;
-                    case 24: color = 'P'; orientation = DiagonalOrientation::NW_SE; break;
-                    case 25: color = 'P'; orientation = DiagonalOrientation::NE_SW; break;
+                switch (value) {
+                    case 16: color = 'Y'; orientation = DiagonalOrientation::NW_SE; break;
+                    case 17: color = 'Y'; orientation = DiagonalOrientation::NE_SW; break;
+                    case 18: color = 'R'; orientation = DiagonalOrientation::NW_SE; break;
+                    case 19: color = 'R'; orientation = DiagonalOrientation::NE_SW; break;
+                    case 20: color = 'B'; orientation = DiagonalOrientation::NW_SE; break;
+                    case 21: color = 'B'; orientation = DiagonalOrientation::NE_SW; break;
+                    case 22: color = 'G'; orientation = DiagonalOrientation::NW_SE; break;
+                    case 23: color = 'G'; orientation = DiagonalOrientation::NE_SW; break;
+                    case 24: color = 'P'; orientation = DiagonalOrientation::NW_SE; break;
+                    case 25: color = 'P'; orientation = DiagonalOrientation::NE_SW; break;
+                }
+                if (color != '?') {
+                    board.addDiagonalWall(x, y, color, orientation);
+                } else {
+                    std::cerr << "Warning: Unhandled diagonal wall code '" << value
+                              << "' at (" << x << ", " << y << "). Skipping." << std::endl;
+                }
+            } else {
+                throw std::runtime_error("Invalid wall value '" + std::to_string(value) +
+                                         "' at (" + std::to_string(x) + ", " +
+                                         std::to_string(y) + "). Expected 0-25.");
+            }
+            x++;
+        }
+
+        if (x != boardWidth) {
+            throw std::runtime_error("Incomplete line at row " + std::to_string(y) +
+                                     ". Expected " + std::to_string(boardWidth) +
+                                     " values, found " + std::to_string(x));
+        }
+        y++;
+    }
+
+    if (y != boardHeight) {
+        throw std::runtime_error("File has incomplete grid. Expected " +
+                                 std::to_string(boardHeight) + " rows, found " +
+                                 std::to_string(y));
+    }
+
+    while (std::getline(file, line)) {
+        int ox, oy;
+        Direction edge;
+        if (parseOpening(line, ox, oy, edge)) board.addOpening(ox, oy, edge);
+    }
+}
+
+// Read-only mapping of a whole file; empty files map to an empty span.
+class MappedFile {
+public:
+    explicit MappedFile(const std::string& filename) {
+        int fd = ::open(filename.c_str(), O_RDONLY);
+        if (fd < 0) {
+            throw std::runtime_error("Could not open file: " + filename);
+        }
+        struct stat st;
+        if (::fstat(fd, &st) != 0) {
+            ::close(fd);
+            throw std::runtime_error("Could not stat file: " + filename);
+        }
+        length = static_cast<size_t>(st.st_size);
+        if (length > 0) {
+            void* mapped = ::mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (mapped == MAP_FAILED) {
+                ::close(fd);
+                throw std::runtime_error("Could not map file: " + filename);
+            }
+            bytes = static_cast<const char*>(mapped);
+        }
+        ::close(fd);
+    }
+
+    ~MappedFile() {
+        if (bytes) ::munmap(const_cast<char*>(bytes), length);
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const char* begin() const { return bytes; }
+    const char* end() const { return bytes + length; }
+    size_t size() const { return length; }
+
+private:
+    const char* bytes = nullptr;
+    size_t length = 0;
+};
+
+inline void mirrorWall(BoardImage& image, int x, int y, Direction dir) {
+    image.cells[y * image.width + x] |= static_cast<uint8_t>(dir);
+    switch (dir) {
+        case Direction::UP:    if (y > 0) image.cells[(y - 1) * image.width + x] |= static_cast<uint8_t>(Direction::DOWN); break;
+        case Direction::DOWN:  if (y + 1 < image.height) image.cells[(y + 1) * image.width + x] |= static_cast<uint8_t>(Direction::UP); break;
+        case Direction::LEFT:  if (x > 0) image.cells[y * image.width + x - 1] |= static_cast<uint8_t>(Direction::RIGHT); break;
+        case Direction::RIGHT: if (x + 1 < image.width) image.cells[y * image.width + x + 1] |= static_cast<uint8_t>(Direction::LEFT); break;
+    }
+}
+
+// BoardImage counterpart of Board::addOpening.
+inline void openEdge(BoardImage& image, int x, int y, Direction edge) {
+    int exit_x, exit_y;
+    if (x < 0 || x >= image.width || y < 0 || y >= image.height ||
+        !openingExit(image.width, image.height, x, y, edge, exit_x, exit_y)) {
+        throw std::invalid_argument("An opening must be on the board edge it opens");
+    }
+    for (auto [cell, side] : {std::pair{y * image.width + x, edge},
+                              std::pair{exit_y * image.width + exit_x, opposite(edge)}}) {
+        image.openings[cell] |= static_cast<uint8_t>(side);
+        image.cells[cell] &= static_cast<uint8_t>(~static_cast<uint8_t>(side));
+    }
+}
+
+// Same text format and errors as loadFromFile, scanned straight out of a
+// memory mapping into the compiled layout instead of through Board.
+BoardImage loadBoardText(const std::string& filename, int width = 16, int height = 16) {
+    static constexpr char DIAGONAL_COLORS[] = {'Y', 'R', 'B', 'G', 'P'};
+    MappedFile file(filename);
+    BoardImage image;
+    image.width = width;
+    image.height = height;
+
+    const char* p = file.begin();
+    const char* end = file.end();
+    int y = 0;
+    while (p < end && y < height) {
+        const char* eol = static_cast<const char*>(std::memchr(p, '\n', end - p));
+        if (!eol) eol = end;
+        const char* line_end = (eol > p && eol[-1] == '\r') ? eol - 1 : eol;
+        if (line_end == p || *p == '#') {
+            p = eol + (eol < end);
+            continue;
+        }
+
+        int x = 0;
+        while (x < width) {
+            while (p < line_end && (*p == ' ' || *p == '\t')) ++p;
+            if (p == line_end) break;
+            bool negative = *p == '-';
+            if (negative) ++p;
+            if (p == line_end || *p < '0' || *p > '9') break;
+            int value = 0;
+            while (p < line_end && *p >= '0' && *p <= '9') value = value * 10 + (*p++ - '0');
+            if (negative) value = -value;
+
+            if (value >= 0 && value <= 15) {
+                for (Direction dir : {Direction::UP, Direction::DOWN, Direction::LEFT, Direction::RIGHT}) {
+                    if (value & static_cast<int>(dir)) mirrorWall(image, x, y, dir);
+                }
+            } else if (value >= 16 && value <= 25) {
+                int color_id = Board::robotColorToIndex.at(DIAGONAL_COLORS[(value - 16) / 2]);
+                image.cells[y * width + x] |= packDiagonal(color_id, static_cast<DiagonalOrientation>(value & 1));
+            } else {
+                throw std::runtime_error("Invalid wall value '" + std::to_string(value) +
+                                         "' at (" + std::to_string(x) + ", " +
+                                         std::to_string(y) + "). Expected 0-25.");
+            }
+            x++;
+        }
+
+        if (x != width) {
+            throw std::runtime_error("Incomplete line at row " + std::to_string(y) +
+                                     ". Expected " + std::to_string(width) +
+                                     " values, found " + std::to_string(x));
+        }
+        y++;
+        p = eol + (eol < end);
+    }
+
+    if (y != height) {
+        throw std::runtime_error("File has incomplete grid. Expected " +
+                                 std::to_string(height) + " rows, found " +
+                                 std::to_string(y));
+    }
+
+    while (p < end) {
+        const char* eol = static_cast<const char*>(std::memchr(p, '\n', end - p));
+        if (!eol) eol = end;
+        int x, oy;
+        Direction edge;
+        if (parseOpening(std::string(p, eol), x, oy, edge)) openEdge(image, x, oy, edge);
+        p = eol + (eol < end);
+    }
+    return image;
+}
+
+// Binary board: a 16-byte header followed by width * height cell bytes in
+// the compiled layout, then as many opening bytes if flag bit 0 is set.
+//   0-3   magic "RRBB"       4  version       5  width       6  height
+//   7     target robot (0xFF = none)         8  target cell
+//   9     robot count (0 = none)             10-14  robot state bytes
+//   15    flags (bit 0: openings follow the cells)
+constexpr char BOARD_MAGIC[4] = {'R', 'R', 'B', 'B'};
+constexpr uint8_t BOARD_FORMAT_VERSION = 1;
+constexpr size_t BOARD_HEADER_BYTES = 16;
+
+bool isBinaryBoard(const std::string& filename) {
+    char magic[4] = {};
+    std::ifstream file(filename, std::ios::binary);
+    return file.read(magic, sizeof(magic)) && std::memcmp(magic, BOARD_MAGIC, sizeof(magic)) == 0;
+}
+
+BoardImage loadBoardBinary(const std::string& filename) {
+    std::ifstream file(filename, std::ios::binary);
+    if (!file.is_open()) {
+        throw std::runtime_error("Could not open file: " + filename);
+    }
+    std::array<uint8_t, BOARD_HEADER_BYTES + 2 * 256> buffer;
+    file.read(reinterpret_cast<char*>(buffer.data()), buffer.size());
+    size_t got = static_cast<size_t>(file.gcount());
+
+    if (got < BOARD_HEADER_BYTES || std::memcmp(buffer.data(), BOARD_MAGIC, 4) != 0 ||
+        buffer[4] != BOARD_FORMAT_VERSION) {
+        throw std::runtime_error("Not a binary board: " + filename);
+    }
+    BoardImage image;
+    image.width = buffer[5];
+    image.height = buffer[6];
+    size_t cells = static_cast<size_t>(image.width) * image.height;
+    bool hasOpenings = buffer[15] & 1;
+    if (image.width < 1 || image.width > 16 || image.height < 1 || image.height > 16 ||
+        got != BOARD_HEADER_BYTES + (hasOpenings ? 2 : 1) * cells) {
+        throw std::runtime_error("Corrupt binary board: " + filename);
+    }
+    std::memcpy(image.cells.data(), buffer.data() + BOARD_HEADER_BYTES, cells);
+    if (hasOpenings) std::memcpy(image.openings.data(), buffer.data() + BOARD_HEADER_BYTES + cells, cells);
+    if (buffer[7] != 0xFF) {
+        if (buffer[7] >= 5 || buffer[8] >= cells) throw std::runtime_error("Corrupt binary board: " + filename);
+        image.targetRobot = buffer[7];
+        image.targetCell = buffer[8];
+    }
+    image.robotCount = buffer[9];
+    if (image.robotCount > 5) throw std::runtime_error("Corrupt binary board: " + filename);
+    std::memcpy(image.robots.data(), buffer.data() + 10, 5);
+    return image;
+}
+
+void saveBoardBinary(const BoardImage& image, const std::string& filename) {
+    std::array<uint8_t, BOARD_HEADER_BYTES> header{};
+    std::memcpy(header.data(), BOARD_MAGIC, 4);
+    header[4] = BOARD_FORMAT_VERSION;
+    header[5] = static_cast<uint8_t>(image.width);
+    header[6] = static_cast<uint8_t>(image.height);
+    header[7] = image.targetRobot < 0 ? 0xFF : static_cast<uint8_t>(image.targetRobot);
+    header[8] = image.targetRobot < 0 ? 0 : static_cast<uint8_t>(image.targetCell);
+    header[9] = static_cast<uint8_t>(image.robotCount);
+    std::memcpy(header.data() + 10, image.robots.data(), 5);
+    bool hasOpenings = std::any_of(image.openings.begin(), image.openings.end(), [](uint8_t e) { return e != 0; });
+    header[15] = hasOpenings ? 1 : 0;
+
+    std::ofstream file(filename, std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) {
+        throw std::runtime_error("Could not open file for writing: " + filename);
+    }
+    file.write(reinterpret_cast<const char*>(header.data()), header.size());
+    file.write(reinterpret_cast<const char*>(image.cells.data()), image.width * image.height);
+    if (hasOpenings) file.write(reinterpret_cast<const char*>(image.openings.data()), image.width * image.height);
+    if (!file) {
+        throw std::runtime_error("Failed writing binary board: " + filename);
+    }
+}
+
+// Writes the text format. A diagonal cell is written as its diagonal code,
+// which drops any wall bits on that cell; walls mirrored from a neighbour
+// come back when the neighbour is reloaded. Openings are written at both
+// ends. Target and robots are not part of the text format.
+void saveBoardText(const BoardImage& image, const std::string& filename) {
+    static constexpr int DIAGONAL_BASE[] = {18, 20, 22, 16, 24};
+    std::ofstream file(filename, std::ios::trunc);
+    if (!file.is_open()) {
+        throw std::runtime_error("Could not open file for writing: " + filename);
+    }
+    for (int y = 0; y < image.height; ++y) {
+        for (int x = 0; x < image.width; ++x) {
+            uint8_t cell = image.cells[y * image.width + x];
+            int value = cell & 0x0F;
+            if (hasDiagonal(cell)) {
+                value = DIAGONAL_BASE[diagonalColorId(cell)] + static_cast<int>(diagonalOrientation(cell));
+            }
+            file << (x ? " " : "") << value;
+        }
+        file << '\n';
+    }
+    for (int cell = 0; cell < image.width * image.height; ++cell) {
+        for (auto [dir, side] : {std::pair{Direction::UP, 'U'}, std::pair{Direction::DOWN, 'D'},
+                                 std::pair{Direction::LEFT, 'L'}, std::pair{Direction::RIGHT, 'R'}}) {
+            if (image.openings[cell] & static_cast<uint8_t>(dir)) {
+                file << "opening " << cell % image.width << ' ' << cell / image.width << ' ' << side << '\n';
+            }
+        }
+    }
+    if (!file) {
+        throw std::runtime_error("Failed writing board: " + filename);
+    }
+}
+
+// Loads either format, telling them apart by the binary magic.
+BoardImage loadBoardImage(const std::string& filename) {
+    return isBinaryBoard(filename) ? loadBoardBinary(filename) : loadBoardText(filename);
+}
+
+// Quarter tiles for composed 16x16 boards, registered by ID. A tile is an
+// 8x8 board (text or binary) drawn as the top-left quadrant, with the board
+// centre at its bottom-right corner; placed top-right, bottom-right or
+// bottom-left it is turned clockwise one, two or three quarter turns. All
+// four placements, and their segment tables, are built when a tile is added,
+// so composing and compiling a layout never walks a tile again.
+class QuadrantLibrary {
+public:
+    static constexpr int SIZE = QuadrantSlides::SIZE;
+    using Cells = std::array<uint8_t, SIZE * SIZE>;
+
+    void add(const std::string& id, const BoardImage& tile) {
+        if (tile.width != SIZE || tile.height != SIZE) {
+            throw std::invalid_argument("Quadrant tile '" + id + "' is not 8x8");
+        }
+        Cells cells;
+        std::copy(tile.cells.begin(), tile.cells.begin() + SIZE * SIZE, cells.begin());
+        Tile placed;
+        for (int position = 0; position < 4; ++position) {
+            placed.cells[position] = cells;
+            placed.slides.emplace_back(cells, ORIGINS[position][0], ORIGINS[position][1]);
+            cells = rotate(cells);
+        }
+        tiles.insert_or_assign(id, std::move(placed));
+    }
+
+    // Every regular file in `directory`, by file name without extension.
+    void loadDirectory(const std::string& directory) {
+        for (const auto& file : std::filesystem::directory_iterator(directory)) {
+            if (file.is_regular_file()) {
+                add(file.path().stem().string(), loadTile(file.path().string()));
+            }
+        }
+    }
+
+    // A registered ID, or else a tile file that is registered under its path.
+    const std::string& resolve(const std::string& idOrFile) {
+        auto it = tiles.find(idOrFile);
+        if (it != tiles.end()) return it->first;
+        if (!std::filesystem::is_regular_file(idOrFile)) {
+            throw std::runtime_error("Unknown quadrant tile: " + idOrFile);
+        }
+        add(idOrFile, loadTile(idOrFile));
+        return tiles.find(idOrFile)->first;
+    }
+
+    bool contains(const std::string& id) const { return tiles.count(id) != 0; }
+    size_t size() const { return tiles.size(); }
+
+    // Tiles in top-left, top-right, bottom-right, bottom-left order. Walls on
+    // a seam are mirrored onto both tiles. The layout points into this
+    // library and is valid while the library is.
+    BoardLayout compose(const std::array<std::string, 4>& ids) const {
+        BoardLayout layout;
+        layout.image.width = 16;
+        layout.image.height = 16;
+        for (int position = 0; position < 4; ++position) {
+            auto it = tiles.find(ids[position]);
+            if (it == tiles.end()) {
+                throw std::runtime_error("Unknown quadrant tile: " + ids[position]);
+            }
+            const Cells& cells = it->second.cells[position];
+            for (int y = 0; y < SIZE; ++y) {
+                std::copy(cells.begin() + y * SIZE, cells.begin() + (y + 1) * SIZE,
+                          layout.image.cells.begin() + (ORIGINS[position][1] + y) * 16 + ORIGINS[position][0]);
+            }
+            layout.quadrants[position] = &it->second.slides[position];
+        }
+        for (int y = 0; y < 16; ++y) {
+            for (int x = 0; x < 16; ++x) {
+                if (x == SIZE - 1) mirrorSeam(layout.image, x, y, Direction::RIGHT);
+                if (x == SIZE)     mirrorSeam(layout.image, x, y, Direction::LEFT);
+                if (y == SIZE - 1) mirrorSeam(layout.image, x, y, Direction::DOWN);
+                if (y == SIZE)     mirrorSeam(layout.image, x, y, Direction::UP);
+            }
+        }
+        return layout;
+    }
+
+    static BoardImage loadTile(const std::string& filename) {
+        return isBinaryBoard(filename) ? loadBoardBinary(filename) : loadBoardText(filename, SIZE, SIZE);
+    }
+
+private:
+    struct Tile {
+        std::array<Cells, 4> cells;
+        std::vector<QuadrantSlides> slides;
+    };
+
+    static constexpr int ORIGINS[4][2] = {{0, 0}, {SIZE, 0}, {SIZE, SIZE}, {0, SIZE}};
+
+    static void mirrorSeam(BoardImage& image, int x, int y, Direction dir) {
+        if (image.cells[y * 16 + x] & static_cast<uint8_t>(dir)) mirrorWall(image, x, y, dir);
+    }
+
+    // One clockwise quarter turn: (x, y) moves to (SIZE-1-y, x), each wall
+    // turns with it, and diagonals swap orientation.
+    static Cells rotate(const Cells& cells) {
+        static constexpr uint8_t TURNED_WALLS[16] = {
+            0, 8, 4, 12, 1, 9, 5, 13, 2, 10, 6, 14, 3, 11, 7, 15
+        };
+        Cells turned{};
+        for (int y = 0; y < SIZE; ++y) {
+            for (int x = 0; x < SIZE; ++x) {
+                uint8_t cell = cells[y * SIZE + x];
+                uint8_t out = TURNED_WALLS[cell & 0x0F];
+                if (hasDiagonal(cell)) {
+                    DiagonalOrientation flipped = diagonalOrientation(cell) == DiagonalOrientation::NW_SE
+                        ? DiagonalOrientation::NE_SW : DiagonalOrientation::NW_SE;
+                    out |= packDiagonal(diagonalColorId(cell), flipped);
+                }
+                turned[x * SIZE + (SIZE - 1 - y)] = out;
+            }
+        }
+        return turned;
+    }
+
+    std::map<std::string, Tile> tiles;
+};
+
+// Unused robot slots stay at {0, 0}, so encode(robots) is the robotCount-robot state.
+struct BatchJob {
+    int robotCount;
+    std::array<std::pair<int, int>, 5> robots;
+    char color;
+    int x;
+    int y;
+};
+
+// One job per line: three to five robot positions in R B G Y P order as
+// "x y" pairs, then the target color and target "x y". Blank lines and
+// lines starting with '#' are skipped.
+BatchJob parseBatchJob(const std::string& line, int line_number) {
+    std::istringstream iss(line);
+    std::vector<std::string> tokens;
+    for (std::string token; iss >> token; ) tokens.push_back(token);
+    size_t coords = tokens.size() < 3 ? 1 : tokens.size() - 3;
+    if (coords % 2 != 0 || coords / 2 < MIN_ROBOTS || coords / 2 > MAX_ROBOTS ||
+        tokens[coords].size() != 1) {
+        throw std::runtime_error("Malformed batch job at line " + std::to_string(line_number));
+    }
+
+    BatchJob job{static_cast<int>(coords / 2), {}, static_cast<char>(std::toupper(tokens[coords][0])), 0, 0};
+    try {
+        for (int r = 0; r < job.robotCount; ++r) {
+            job.robots[r] = {std::stoi(tokens[2 * r]), std::stoi(tokens[2 * r + 1])};
+        }
+        job.x = std::stoi(tokens[coords + 1]);
+        job.y = std::stoi(tokens[coords + 2]);
+    } catch (const std::logic_error&) {
+        throw std::runtime_error("Malformed batch job at line " + std::to_string(line_number));
+    }
+    if (!Board::robotColorToIndex.count(job.color) ||
+        Board::robotColorToIndex.at(job.color) >= job.robotCount) {
+        throw std::runtime_error("Invalid target color at line " + std::to_string(line_number));
+    }
+    return job;
+}
+
+std::vector<BatchJob> readBatchJobs(std::istream& in) {
+    std::vector<BatchJob> jobs;
+    std::string line;
+    int line_number = 0;
+    while (std::getline(in, line)) {
+        line_number++;
+        if (line.empty() || line[0] == '#') continue;
+        jobs.push_back(parseBatchJob(line, line_number));
+    }
+    return jobs;
+}
+
+std::string formatMoves(const std::vector<Move>& moves) {
+    std::string out;
+    for (const auto& move : moves) {
+        if (!out.empty()) out += ' ';
+        out += Board::robotIndexToColor.at(move.robot);
+        switch (move.dir) {
+            case Direction::UP:    out += 'U'; break;
+            case Direction::DOWN:  out += 'D'; break;
+            case Direction::LEFT:  out += 'L'; break;
+            case Direction::RIGHT: out += 'R'; break;
+        }
+    }
+    return out;
+}
+
+// Default expansion cap for one --batch group search: enough for puzzles of
+// ordinary depth. A 5-robot group that runs into it peaks near 1.8 GB, about
+// BATCH_BYTES_PER_NODE per expansion, and every group running at once holds
+// its own parent map, so runBatch caps the number of concurrent groups at
+// `memoryBytes` divided by that per-group cost.
+constexpr uint64_t DEFAULT_BATCH_NODES = 20000000;
+constexpr size_t BATCH_BYTES_PER_NODE = 96;
+constexpr size_t DEFAULT_BATCH_MEMORY = size_t{8} << 30;
+
+// Solves every job against one compiled board. Jobs that share initial
+// positions share a single BFS that collects all of their targets; the
+// groups themselves run in parallel, each on the BasicSolver instance for
+// its robot count and on an arena reused by later groups. Each group's BFS
+// stops after `timeout` or `maxNodes` expanded states (zero disables either);
+// with a node cap, only as many groups run at once as fit in `memoryBytes`.
+// Writes "job,color,x,y,length,moves,status" per job in input order; status
+// is "solved", "unsolvable" (the search space was exhausted) or "unsolved"
+// (a limit stopped the search first), with length -1 for the last two.
+void runBatch(const CompiledBoard& compiled, const std::vector<BatchJob>& jobs, std::ostream& out,
+              SolutionCache* cache = nullptr, std::chrono::milliseconds timeout = std::chrono::milliseconds(0),
+              uint64_t maxNodes = DEFAULT_BATCH_NODES, size_t memoryBytes = DEFAULT_BATCH_MEMORY) {
+    const int width = compiled.getWidth();
+    const int height = compiled.getHeight();
+
+    std::map<std::pair<int, State>, std::vector<size_t>> byInitial;
+    for (size_t i = 0; i < jobs.size(); ++i) {
+        const BatchJob& job = jobs[i];
+        for (int r = 0; r < job.robotCount; ++r) {
+            auto [x, y] = job.robots[r];
+            if (x < 0 || x >= width || y < 0 || y >= height) {
+                throw std::runtime_error("Robot position out of bounds in job " + std::to_string(i));
+            }
+            for (int q = 0; q < r; ++q) {
+                if (job.robots[q] == job.robots[r]) {
+                    throw std::runtime_error("Robots overlap in job " + std::to_string(i));
                 }
-                if (color != '?') {
-                    board.addDiagonalWall(x, y, color, orientation);
-                } else {
-                    std::cerr << "Warning: Unhandled diagonal wall code '" << value
-                              << "' at (" << x << ", " << y << "). Skipping." << std::endl;
+            }
+        }
+        if (job.x < 0 || job.x >= width || job.y < 0 || job.y >= height) {
+            throw std::runtime_error("Target out of bounds in job " + std::to_string(i));
+        }
+        byInitial[{job.robotCount, encode(job.robots)}].push_back(i);
+    }
+
+    std::vector<std::pair<std::pair<int, State>, std::vector<size_t>>> groups(byInitial.begin(), byInitial.end());
+    std::vector<std::optional<std::vector<Move>>> results(jobs.size());
+    std::vector<char> unsolved(jobs.size(), 0);
+    SearchArenaPool arenas;
+
+    auto solveGroup = [&](size_t g) {
+        const auto& [key, members] = groups[g];
+        std::vector<Goal> goals;
+        std::vector<size_t> pending;
+        for (size_t i : members) {
+            Goal goal{Board::robotColorToIndex.at(jobs[i].color), jobs[i].y * width + jobs[i].x};
+            if (cache) {
+                auto hit = cache->find(SolutionCache::key(compiled, key.first, key.second, goal.robot, goal.cell));
+                if (hit) {
+                    results[i] = std::move(*hit);
+                    continue;
+                }
+            }
+            goals.push_back(goal);
+            pending.push_back(i);
+        }
+        if (goals.empty()) return;
+
+        bool cancelled = false;
+        auto paths = withRobotCount(key.first, [&](auto robots) {
+            BasicSolver<decltype(robots)::value> solver(compiled, key.second, goals[0].robot, goals[0].cell);
+            auto lease = arenas.acquire();
+            solver.setArena(lease.get());
+            solver.setLimits(timeout, maxNodes);
+            auto found = solver.solve_goals(goals);
+            cancelled = solver.getStats().cancelled;
+            return found;
+        });
+        for (size_t k = 0; k < pending.size(); ++k) {
+            if (cancelled && !paths[k]) {
+                unsolved[pending[k]] = 1;
+                continue;
+            }
+            if (cache) {
+                cache->insert(SolutionCache::key(compiled, key.first, key.second, goals[k].robot, goals[k].cell),
+                              paths[k]);
+            }
+            results[pending[k]] = std::move(paths[k]);
+        }
+    };
+    int concurrency = tbb::this_task_arena::max_concurrency();
+    if (maxNodes) {
+        uint64_t fit = memoryBytes / BATCH_BYTES_PER_NODE / maxNodes;
+        concurrency = static_cast<int>(std::clamp<uint64_t>(fit, 1, concurrency));
+    }
+    tbb::task_arena groupArena(concurrency);
+    groupArena.execute([&] { tbb::parallel_for(size_t{0}, groups.size(), solveGroup); });
+
+    for (size_t i = 0; i < jobs.size(); ++i) {
+        out << i << ',' << jobs[i].color << ',' << jobs[i].x << ',' << jobs[i].y << ','
+            << (results[i] ? static_cast<long>(results[i]->size()) : -1L) << ','
+            << (results[i] ? formatMoves(*results[i]) : "") << ','
+            << (results[i] ? "solved" : unsolved[i] ? "unsolved" : "unsolvable") << '\n';
+    }
+    out << std::flush;
+}
+
+long peakResidentKilobytes() {
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+}
+
+// Runs every engine on seeded random puzzles for each board and writes one
+// CSV row per run. Targets are drawn from a distance database of the random
+// start, so every puzzle is solvable in 1..maxMoves moves and runtimes stay
+// bounded. The parallel engine is repeated for 1, 2, 4, ... maxThreads
+// threads. Peak RSS is the process high-water mark at the end of each run.
+void runBenchmark(const std::vector<std::string>& boardFiles, int maxMoves, int configsPerBoard,
+                  int maxThreads, unsigned seed, std::ostream& out) {
+    std::mt19937 rng(seed);
+    out << "board,config,robots,target,engine,threads,moves,expanded,seconds,"
+           "states_per_sec,peak_rss_kb,level_seconds\n";
+
+    for (const std::string& file : boardFiles) {
+        CompiledBoard compiled(loadBoardImage(file));
+        const int cells = compiled.getWidth() * compiled.getHeight();
+        std::uniform_int_distribution<int> cellDist(0, cells - 1);
+
+        for (int config = 0; config < configsPerBoard; ++config) {
+            std::array<std::pair<int, int>, 5> robots;
+            std::vector<Goal> candidates;
+            for (int attempt = 0; candidates.empty(); ++attempt) {
+                if (attempt == 100) {
+                    throw std::runtime_error("No solvable configuration found for " + file);
+                }
+                std::vector<int> used;
+                for (auto& robot : robots) {
+                    int cell;
+                    do cell = cellDist(rng); while (std::find(used.begin(), used.end(), cell) != used.end());
+                    used.push_back(cell);
+                    robot = {cell % compiled.getWidth(), cell / compiled.getWidth()};
+                }
+                DistanceDatabase db = DistanceDatabase::build(compiled, encode(robots), maxMoves);
+                for (int robot = 0; robot < 5; ++robot) {
+                    for (int cell = 0; cell < cells; ++cell) {
+                        if (db.distance(robot, cell) > 0) candidates.push_back({robot, cell});
+                    }
+                }
+            }
+            Goal goal = candidates[std::uniform_int_distribution<size_t>(0, candidates.size() - 1)(rng)];
+
+            std::string robotsField;
+            for (const auto& [x, y] : robots) {
+                if (!robotsField.empty()) robotsField += ';';
+                robotsField += std::to_string(x) + ' ' + std::to_string(y);
+            }
+            std::string targetField = std::string(1, Board::robotIndexToColor.at(goal.robot)) + ' ' +
+                                      std::to_string(goal.cell % compiled.getWidth()) + ' ' +
+                                      std::to_string(goal.cell / compiled.getWidth());
+
+            auto run = [&](const std::string& engine, int threads, auto solve) {
+                Solver solver(compiled, encode(robots), goal.robot, goal.cell);
+                auto start = std::chrono::steady_clock::now();
+                std::vector<Move> solution = solve(solver);
+                double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+                const SearchStats& stats = solver.getStats();
+                std::string levels;
+                for (const LevelStats& level : stats.levels) {
+                    if (!levels.empty()) levels += ';';
+                    levels += std::to_string(level.seconds);
+                }
+                out << file << ',' << config << ',' << robotsField << ',' << targetField << ','
+                    << engine << ',' << threads << ',' << solution.size() << ',' << stats.expanded << ','
+                    << seconds << ',' << (seconds > 0 ? stats.expanded / seconds : 0.0) << ','
+                    << peakResidentKilobytes() << ',' << levels << '\n' << std::flush;
+            };
+
+            run("sequential", 1, [](Solver& s) { return s.solve_sequential(); });
+            run("sequential-compact", 1, [](Solver& s) {
+                s.setCompactParents(true);
+                return s.solve_sequential();
+            });
+            for (int threads = 1; ; threads = std::min(threads * 2, maxThreads)) {
+                tbb::global_control limit(tbb::global_control::max_allowed_parallelism, threads);
+                run("parallel", threads, [](Solver& s) { return s.solve(); });
+                if (threads == maxThreads) break;
+            }
+            run("bidirectional", 1, [](Solver& s) { return s.solve_bidirectional(); });
+            run("ida", 1, [](Solver& s) { return s.solve_ida(); });
+            run("staged", 1, [](Solver& s) { return s.solve_staged(); });
+            run("external", 1, [](Solver& s) { return s.solve_external(); });
+        }
+    }
+}
+
+// Reads five "x y" robot positions (R B G Y P order) from argv[first..first+9].
+std::array<std::pair<int, int>, 5> parsePositions(char* argv[], int first, int width, int height) {
+    std::array<std::pair<int, int>, 5> robots;
+    for (int r = 0; r < 5; ++r) {
+        robots[r] = {std::stoi(argv[first + 2 * r]), std::stoi(argv[first + 2 * r + 1])};
+        if (robots[r].first < 0 || robots[r].first >= width ||
+            robots[r].second < 0 || robots[r].second >= height) {
+            throw std::runtime_error("Robot position out of bounds");
+        }
+        for (int q = 0; q < r; ++q) {
+            if (robots[q] == robots[r]) throw std::runtime_error("Robots overlap");
+        }
+    }
+    return robots;
+}
+
+// One solve described by command-line flags, as taken by --solve and by each
+// line of --serve:
+//   --board <file>  --robots <x y> x3..5  --target <color x y>
+//   --engine sequential|sequential-compact|parallel|bidirectional|ida|staged|external
+//   --threads <n>  --timeout <ms>  --max-nodes <n>  --memory <MiB>
+//   --canonical  --levels  --id <token>  --priority <n>
+// Zero or missing limits leave the engine's defaults in place. `--priority`
+// only orders jobs waiting in the --serve scheduler; higher starts first.
+struct SolveRequest {
+    std::string id;
+    std::string board = "boardstate.txt";
+    BatchJob job{0, {}, 'R', -1, -1};
+    std::string engine = "parallel";
+    int threads = 0;
+    std::chrono::milliseconds timeout{0};
+    uint64_t maxNodes = 0;
+    size_t memoryBytes = 0;
+    bool canonical = false;
+    bool levels = false;
+    int priority = 0;
+};
+
+SolveRequest parseSolveRequest(const std::vector<std::string>& args) {
+    static const std::vector<std::string> ENGINES = {
+        "sequential", "sequential-compact", "parallel", "bidirectional", "ida", "staged", "external"
+    };
+    SolveRequest request;
+    bool hasRobots = false;
+    bool hasTarget = false;
+    for (size_t i = 0; i < args.size(); ) {
+        const std::string& flag = args[i];
+        if (flag.rfind("--", 0) != 0) {
+            throw std::runtime_error("Expected a flag, found '" + flag + "'");
+        }
+        std::vector<std::string> values;
+        for (++i; i < args.size() && args[i].rfind("--", 0) != 0; ++i) values.push_back(args[i]);
+        auto expect = [&](size_t count) {
+            if (values.size() != count) {
+                throw std::runtime_error(flag + " takes " + std::to_string(count) + " value(s)");
+            }
+        };
+        try {
+            if (flag == "--id") {
+                expect(1);
+                request.id = values[0];
+            } else if (flag == "--board") {
+                expect(1);
+                request.board = values[0];
+            } else if (flag == "--robots") {
+                if (values.size() % 2 != 0 || values.size() / 2 < MIN_ROBOTS || values.size() / 2 > MAX_ROBOTS) {
+                    throw std::runtime_error("--robots takes " + std::to_string(MIN_ROBOTS) + " to " +
+                                             std::to_string(MAX_ROBOTS) + " x y pairs");
+                }
+                request.job.robotCount = static_cast<int>(values.size() / 2);
+                request.job.robots = {};
+                for (int r = 0; r < request.job.robotCount; ++r) {
+                    request.job.robots[r] = {std::stoi(values[2 * r]), std::stoi(values[2 * r + 1])};
+                }
+                hasRobots = true;
+            } else if (flag == "--target") {
+                expect(3);
+                if (values[0].size() != 1) throw std::runtime_error("Invalid target color");
+                request.job.color = static_cast<char>(std::toupper(static_cast<unsigned char>(values[0][0])));
+                request.job.x = std::stoi(values[1]);
+                request.job.y = std::stoi(values[2]);
+                hasTarget = true;
+            } else if (flag == "--engine") {
+                expect(1);
+                if (std::find(ENGINES.begin(), ENGINES.end(), values[0]) == ENGINES.end()) {
+                    throw std::runtime_error("Unknown engine: " + values[0]);
                 }
+                request.engine = values[0];
+            } else if (flag == "--threads") {
+                expect(1);
+                request.threads = std::stoi(values[0]);
+                if (request.threads < 0) throw std::runtime_error("--threads must not be negative");
+            } else if (flag == "--timeout") {
+                expect(1);
+                request.timeout = std::chrono::milliseconds(std::stoll(values[0]));
+            } else if (flag == "--max-nodes") {
+                expect(1);
+                request.maxNodes = std::stoull(values[0]);
+            } else if (flag == "--memory") {
+                expect(1);
+                request.memoryBytes = static_cast<size_t>(std::stoull(values[0])) << 20;
+            } else if (flag == "--canonical") {
+                expect(0);
+                request.canonical = true;
+            } else if (flag == "--levels") {
+                expect(0);
+                request.levels = true;
+            } else if (flag == "--priority") {
+                expect(1);
+                request.priority = std::stoi(values[0]);
             } else {
-                throw std::runtime_error("Invalid wall value '" + std::to_string(value) +
-                                         "' at (" + std::to_string(x) + ", " +
-                                         std::to_string(y) + "). Expected 0-25.");
+                throw std::runtime_error("Unknown flag: " + flag);
             }
-            x++;
+        } catch (const std::logic_error&) {
+            throw std::runtime_error("Invalid value for " + flag);
         }
+    }
+    if (!hasRobots || !hasTarget) {
+        throw std::runtime_error("--robots and --target are required");
+    }
+    if (!Board::robotColorToIndex.count(request.job.color) ||
+        Board::robotColorToIndex.at(request.job.color) >= request.job.robotCount) {
+        throw std::runtime_error("Invalid target color");
+    }
+    return request;
+}
 
-        if (x != boardWidth) {
-            throw std::runtime_error("Incomplete line at row " + std::to_string(y) +
-                                     ". Expected " + std::to_string(boardWidth) +
-                                     " values, found " + std::to_string(x));
+std::string jsonString(const std::string& text) {
+    std::string out = "\"";
+    for (char c : text) {
+        switch (c) {
+            case '"':  out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\n': out += "\\n"; break;
+            case '\t': out += "\\t"; break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    char escaped[8];
+                    std::snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+                    out += escaped;
+                } else {
+                    out += c;
+                }
         }
-        y++;
     }
+    return out + "\"";
+}
 
-    if (y != boardHeight) {
-        throw std::runtime_error("File has incomplete grid. Expected " +
-                                 std::to_string(boardHeight) + " rows, found " +
-                                 std::to_string(y));
+// What one engine run of a request produced, ready to be written out.
+struct SolveOutcome {
+    std::string engine;
+    size_t threads = 1;
+    std::vector<Move> solution;
+    SearchStats stats;
+    double seconds = 0;
+};
+
+void validateSolveRequest(const CompiledBoard& compiled, const SolveRequest& request) {
+    const BatchJob& job = request.job;
+    const int width = compiled.getWidth();
+    for (int r = 0; r < job.robotCount; ++r) {
+        auto [x, y] = job.robots[r];
+        if (x < 0 || x >= width || y < 0 || y >= compiled.getHeight()) {
+            throw std::runtime_error("Robot position out of bounds");
+        }
+        for (int q = 0; q < r; ++q) {
+            if (job.robots[q] == job.robots[r]) throw std::runtime_error("Robots overlap");
+        }
+    }
+    if (job.x < 0 || job.x >= width || job.y < 0 || job.y >= compiled.getHeight()) {
+        throw std::runtime_error("Target out of bounds");
+    }
+}
+
+// Runs `engine` on a validated request with the given limits, on the
+// calling thread (plus TBB workers for the parallel engine), using `arena`
+// for the search structures when one is given.
+SolveOutcome executeSolveRequest(const CompiledBoard& compiled, const SolveRequest& request,
+                                 const std::string& engine, std::chrono::milliseconds timeout, uint64_t maxNodes,
+                                 SearchArena* arena = nullptr) {
+    const BatchJob& job = request.job;
+    const int targetRobot = Board::robotColorToIndex.at(job.color);
+    const int targetCell = job.y * compiled.getWidth() + job.x;
+
+    SolveOutcome outcome;
+    outcome.engine = engine;
+    auto start = std::chrono::steady_clock::now();
+    withRobotCount(job.robotCount, [&](auto robots) {
+        BasicSolver<decltype(robots)::value> solver(compiled, encode(job.robots), targetRobot, targetCell);
+        solver.setLimits(timeout, maxNodes);
+        solver.setCanonicalStates(request.canonical);
+        solver.setArena(arena);
+        if (request.memoryBytes) {
+            solver.setMemoryBudget(request.memoryBytes);
+            solver.setExternalStorage(std::filesystem::temp_directory_path(), request.memoryBytes);
+        }
+        std::vector<Move>& solution = outcome.solution;
+        if (engine == "sequential") {
+            solution = solver.solve_sequential();
+        } else if (engine == "sequential-compact") {
+            solver.setCompactParents(true);
+            solution = solver.solve_sequential();
+        } else if (engine == "parallel") {
+            solution = solver.solve();
+        } else if (engine == "bidirectional") {
+            solution = solver.solve_bidirectional();
+        } else if (engine == "ida") {
+            solution = solver.solve_ida();
+        } else if (engine == "staged") {
+            solution = solver.solve_staged();
+        } else {
+            solution = solver.solve_external();
+        }
+        outcome.stats = solver.getStats();
+    });
+    outcome.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return outcome;
+}
+
+SolutionCache::Key solveCacheKey(const CompiledBoard& compiled, const SolveRequest& request) {
+    const BatchJob& job = request.job;
+    return SolutionCache::key(compiled, job.robotCount, encode(job.robots), Board::robotColorToIndex.at(job.color),
+                              job.y * compiled.getWidth() + job.x);
+}
+
+// A cached answer for `request` as an outcome of engine "cache" that expanded
+// nothing, or nullopt on a miss or without a cache.
+std::optional<SolveOutcome> findCachedOutcome(SolutionCache* cache, const CompiledBoard& compiled,
+                                              const SolveRequest& request) {
+    if (!cache) return std::nullopt;
+    auto hit = cache->find(solveCacheKey(compiled, request));
+    if (!hit) return std::nullopt;
+    SolveOutcome outcome;
+    outcome.engine = "cache";
+    if (*hit) {
+        outcome.solution = std::move(**hit);
+        outcome.stats.exhaustedDepth = static_cast<int>(outcome.solution.size()) - 1;
+    }
+    return outcome;
+}
+
+// Records a finished outcome: a solution, or an unreachable target when the
+// search ran to exhaustion. Cancelled searches prove nothing and are skipped.
+void cacheOutcome(SolutionCache* cache, const CompiledBoard& compiled, const SolveRequest& request,
+                  const SolveOutcome& outcome) {
+    if (!cache) return;
+    const BatchJob& job = request.job;
+    const int targetRobot = Board::robotColorToIndex.at(job.color);
+    bool atTarget = job.robots[targetRobot] == std::make_pair(job.x, job.y);
+    if (!outcome.solution.empty() || atTarget) {
+        cache->insert(solveCacheKey(compiled, request), outcome.solution);
+    } else if (!outcome.stats.cancelled) {
+        cache->insert(solveCacheKey(compiled, request), std::nullopt);
+    }
+}
+
+void reportCacheStats(const SolutionCache& cache) {
+    SolutionCache::Stats cs = cache.getStats();
+    std::cerr << "Cache: " << cs.hits << " hits, " << cs.diskHits << " disk hits, "
+              << cs.misses << " misses, " << cs.evictions << " evictions" << std::endl;
+}
+
+// Removes the process-wide "--cache <MiB>" and "--cache-file <file>" flags
+// from `args` and returns the cache they ask for: in memory only with just a
+// budget, backed by a log with a file. Returns null when neither is given.
+std::unique_ptr<SolutionCache> takeCacheFlags(std::vector<std::string>& args) {
+    size_t budget = 0;
+    std::string file;
+    for (size_t i = 0; i < args.size(); ) {
+        if (args[i] != "--cache" && args[i] != "--cache-file") {
+            ++i;
+            continue;
+        }
+        if (i + 1 == args.size()) throw std::invalid_argument(args[i] + " takes 1 value");
+        if (args[i] == "--cache") {
+            long long mib = std::stoll(args[i + 1]);
+            if (mib <= 0) throw std::invalid_argument("--cache must be positive");
+            budget = static_cast<size_t>(mib) << 20;
+        } else {
+            file = args[i + 1];
+        }
+        args.erase(args.begin() + i, args.begin() + i + 2);
+    }
+    if (!budget && file.empty()) return nullptr;
+    return std::make_unique<SolutionCache>(budget ? budget : SolutionCache::DEFAULT_MEMORY_BUDGET, file);
+}
+
+// Writes a request's outcome as a single JSON object line. `status` is
+// "solved", "unsolvable" (the search space was exhausted) or "cancelled" (a
+// limit was hit; exhausted_depth still bounds the answer).
+void writeSolveOutcome(std::ostream& out, const SolveRequest& request, const SolveOutcome& outcome) {
+    const BatchJob& job = request.job;
+    const std::vector<Move>& solution = outcome.solution;
+    const SearchStats& stats = outcome.stats;
+    const double seconds = outcome.seconds;
+    const int targetRobot = Board::robotColorToIndex.at(job.color);
+
+    const char* status = "solved";
+    if (solution.empty() && job.robots[targetRobot] != std::make_pair(job.x, job.y)) {
+        status = stats.cancelled ? "cancelled" : "unsolvable";
+    }
+
+    out << '{';
+    if (!request.id.empty()) out << "\"id\":" << jsonString(request.id) << ',';
+    out << "\"board\":" << jsonString(request.board)
+        << ",\"engine\":" << jsonString(outcome.engine)
+        << ",\"threads\":" << outcome.threads
+        << ",\"robots\":" << job.robotCount
+        << ",\"target\":{\"color\":\"" << job.color << "\",\"x\":" << job.x << ",\"y\":" << job.y << '}'
+        << ",\"status\":\"" << status << '"'
+        << ",\"length\":" << (std::strcmp(status, "solved") == 0 ? static_cast<long>(solution.size()) : -1L)
+        << ",\"moves\":[";
+    for (size_t i = 0; i < solution.size(); ++i) {
+        out << (i ? "," : "") << '"' << formatMoves({solution[i]}) << '"';
+    }
+    out << "],\"seconds\":" << seconds
+        << ",\"expanded\":" << stats.expanded
+        << ",\"states_per_sec\":" << (seconds > 0 ? stats.expanded / seconds : 0.0)
+        << ",\"exhausted_depth\":" << stats.exhaustedDepth
+        << ",\"peak_rss_kb\":" << peakResidentKilobytes();
+    if (request.levels) {
+        out << ",\"levels\":[";
+        for (size_t i = 0; i < stats.levels.size(); ++i) {
+            const LevelStats& level = stats.levels[i];
+            out << (i ? "," : "") << "{\"depth\":" << level.depth
+                << ",\"frontier\":" << level.frontier
+                << ",\"inserted\":" << level.inserted
+                << ",\"duplicates\":" << level.duplicates
+                << ",\"load_factor\":" << level.loadFactor
+                << ",\"move_seconds\":" << level.moveSeconds
+                << ",\"insert_seconds\":" << level.insertSeconds
+                << ",\"bytes\":" << level.bytes
+                << ",\"seconds\":" << level.seconds << '}';
+        }
+        out << ']';
+    }
+    out << "}\n" << std::flush;
+}
+
+// Runs one request on the calling thread and writes its JSON line. With a
+// cache, a known answer is written without searching.
+void runSolveRequest(const CompiledBoard& compiled, const SolveRequest& request, std::ostream& out,
+                     SearchArena* arena = nullptr, SolutionCache* cache = nullptr) {
+    validateSolveRequest(compiled, request);
+    if (auto cached = findCachedOutcome(cache, compiled, request)) {
+        writeSolveOutcome(out, request, *cached);
+        return;
+    }
+    std::optional<tbb::global_control> threadLimit;
+    if (request.threads > 0) {
+        threadLimit.emplace(tbb::global_control::max_allowed_parallelism, request.threads);
+    }
+    SolveOutcome outcome = executeSolveRequest(compiled, request, request.engine, request.timeout, request.maxNodes,
+                                               arena);
+    outcome.threads = tbb::global_control::active_value(tbb::global_control::max_allowed_parallelism);
+    cacheOutcome(cache, compiled, request, outcome);
+    writeSolveOutcome(out, request, outcome);
+}
+
+// Runs many requests at once on one TBB task arena. Queued jobs start in
+// order of priority (higher first), then deadline, then submission; the
+// deadline is submission time plus the request's timeout, so queueing time
+// counts against it and a job that expires before it starts is answered
+// "cancelled" without searching. Each job runs as one arena task. A
+// "parallel" request first runs the sequential engine capped at
+// SMALL_JOB_NODES expansions, so small puzzles skip the per-level barriers of
+// solve(); only puzzles that outgrow the cap rerun with solve(), whose
+// parallel_for spreads over whichever arena workers are idle. A rerun's
+// "expanded" and "seconds" include the capped pre-pass, which also counts
+// against `--max-nodes`, and its "exhausted_depth" is the deeper of the two
+// runs; its "levels" are solve()'s alone. Other engines
+// run as requested on one worker and `--threads` is ignored. Each job leases
+// a search arena for both of its runs. With a cache, a job whose answer is
+// known skips the search. JSON lines are written to `out` in completion
+// order. Submitted boards and the cache must outlive wait().
+class SolveScheduler {
+public:
+    static constexpr uint64_t SMALL_JOB_NODES = 200000;
+
+    SolveScheduler(std::ostream& out, int workers, SolutionCache* cache = nullptr)
+        : out(out), cache(cache), arena(workers > 0 ? workers : tbb::task_arena::automatic, 0) {}
+
+    ~SolveScheduler() { wait(); }
+
+    void submit(const CompiledBoard& compiled, SolveRequest request) {
+        auto now = std::chrono::steady_clock::now();
+        auto deadline = request.timeout.count() > 0 ? now + request.timeout
+                                                    : std::chrono::steady_clock::time_point::max();
+        {
+            std::lock_guard<std::mutex> lock(queueMutex);
+            queue.push(Job{&compiled, std::move(request), deadline, submitted++});
+        }
+        arena.execute([this] { group.run([this] { runNext(); }); });
+    }
+
+    void wait() {
+        arena.execute([this] { group.wait(); });
+    }
+
+    // Writes one already-formatted line without interleaving with results.
+    void write(const std::string& line) {
+        std::lock_guard<std::mutex> lock(outMutex);
+        out << line << std::flush;
+    }
+
+private:
+    struct Job {
+        const CompiledBoard* compiled;
+        SolveRequest request;
+        std::chrono::steady_clock::time_point deadline;
+        uint64_t sequence;
+    };
+
+    // Orders the priority queue so that top() is the job to start next.
+    struct StartsLater {
+        bool operator()(const Job& a, const Job& b) const {
+            if (a.request.priority != b.request.priority) return a.request.priority < b.request.priority;
+            if (a.deadline != b.deadline) return a.deadline > b.deadline;
+            return a.sequence > b.sequence;
+        }
+    };
+
+    // Every submit() queues one job and one task, so the queue is never empty
+    // here; the task just takes whichever job is most urgent by now.
+    void runNext() {
+        Job job;
+        {
+            std::lock_guard<std::mutex> lock(queueMutex);
+            job = queue.top();
+            queue.pop();
+        }
+        const SolveRequest& request = job.request;
+        std::ostringstream line;
+        try {
+            validateSolveRequest(*job.compiled, request);
+            std::optional<SolveOutcome> outcome = findCachedOutcome(cache, *job.compiled, request);
+            if (!outcome) {
+                outcome = run(job);
+                cacheOutcome(cache, *job.compiled, request, *outcome);
+            }
+            writeSolveOutcome(line, request, *outcome);
+        } catch (const std::exception& e) {
+            line.str("");
+            line << '{';
+            if (!request.id.empty()) line << "\"id\":" << jsonString(request.id) << ',';
+            line << "\"error\":" << jsonString(e.what()) << "}\n";
+        }
+        write(line.str());
+    }
+
+    SolveOutcome run(const Job& job) {
+        const SolveRequest& request = job.request;
+        auto start = std::chrono::steady_clock::now();
+        auto remaining = [&job] {
+            if (job.deadline == std::chrono::steady_clock::time_point::max()) return std::chrono::milliseconds(0);
+            auto left = std::chrono::duration_cast<std::chrono::milliseconds>(job.deadline - std::chrono::steady_clock::now());
+            return std::max(left, std::chrono::milliseconds(1));
+        };
+        if (std::chrono::steady_clock::now() >= job.deadline) {
+            SolveOutcome expired;
+            expired.engine = request.engine;
+            expired.stats.cancelled = true;
+            return expired;
+        }
+        auto lease = arenas.acquire();
+        if (request.engine != "parallel") {
+            return executeSolveRequest(*job.compiled, request, request.engine, remaining(), request.maxNodes,
+                                       lease.get());
+        }
+
+        bool capped = request.maxNodes == 0 || request.maxNodes > SMALL_JOB_NODES;
+        SolveOutcome outcome = executeSolveRequest(*job.compiled, request, "sequential", remaining(),
+                                                   capped ? SMALL_JOB_NODES : request.maxNodes, lease.get());
+        // The pre-pass checks its cap only every LIMIT_CHECK_INTERVAL
+        // expansions, so it may already have spent all of --max-nodes.
+        bool budgetLeft = request.maxNodes == 0 || outcome.stats.expanded < request.maxNodes;
+        if (capped && budgetLeft && outcome.stats.cancelled && outcome.stats.expanded >= SMALL_JOB_NODES &&
+            std::chrono::steady_clock::now() < job.deadline) {
+            SearchStats prepass = outcome.stats;
+            uint64_t budget = request.maxNodes == 0 ? 0 : request.maxNodes - prepass.expanded;
+            outcome = executeSolveRequest(*job.compiled, request, "parallel", remaining(), budget, lease.get());
+            outcome.stats.expanded += prepass.expanded;
+            outcome.stats.exhaustedDepth = std::max(outcome.stats.exhaustedDepth, prepass.exhaustedDepth);
+            outcome.threads = arena.max_concurrency();
+            outcome.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        }
+        return outcome;
     }
+
+    std::ostream& out;
+    SolutionCache* cache;
+    std::mutex outMutex;
+    std::mutex queueMutex;
+    std::priority_queue<Job, std::vector<Job>, StartsLater> queue;
+    uint64_t submitted = 0;
+    SearchArenaPool arenas;
+    tbb::task_arena arena;
+    tbb::task_group group;
+};
+
+// Request loop for long-running workers: one flag line per request on `in`
+// (blank and '#' lines skipped), one JSON line per request on `out`. Boards
+// are compiled on first use and kept for the life of the loop; a failed
+// request answers {"error": ...} and the loop carries on. With `workers` > 0
+// requests go to a SolveScheduler of that many threads and are answered as
+// they finish; otherwise they are answered one at a time, in order, all on
+// one search arena. Either way a `cache` answers repeated queries.
+void serveRequests(std::istream& in, std::ostream& out, int workers = 0, SolutionCache* cache = nullptr) {
+    std::optional<SolveScheduler> scheduler;
+    if (workers > 0) scheduler.emplace(out, workers, cache);
+    SearchArena arena;
+    std::map<std::string, std::unique_ptr<CompiledBoard>> boards;
+    std::string line;
+    while (std::getline(in, line)) {
+        if (line.empty() || line[0] == '#') continue;
+        std::istringstream iss(line);
+        std::vector<std::string> args;
+        for (std::string token; iss >> token; ) args.push_back(token);
+        if (args.empty()) continue;
+        auto idFlag = std::find(args.begin(), args.end(), "--id");
+        std::string id = idFlag != args.end() && idFlag + 1 != args.end() ? *(idFlag + 1) : "";
+        try {
+            SolveRequest request = parseSolveRequest(args);
+            auto& compiled = boards[request.board];
+            if (!compiled) compiled = std::make_unique<CompiledBoard>(loadBoardImage(request.board));
+            if (scheduler) {
+                scheduler->submit(*compiled, std::move(request));
+            } else {
+                runSolveRequest(*compiled, request, out, &arena, cache);
+            }
+        } catch (const std::exception& e) {
+            std::ostringstream error;
+            error << '{';
+            if (!id.empty()) error << "\"id\":" << jsonString(id) << ',';
+            error << "\"error\":" << jsonString(e.what()) << "}\n";
+            if (scheduler) {
+                scheduler->write(error.str());
+            } else {
+                out << error.str() << std::flush;
+            }
+        }
+    }
+    if (scheduler) scheduler->wait();
+}
+
+// Move-rule regression cases, run by --self-test. Prints one line per
+// failed case and returns the number of failures.
+int runSelfTests(std::ostream& out) {
+    int failures = 0;
+    auto check = [&](bool ok, const std::string& name) {
+        if (!ok) {
+            out << "FAIL " << name << std::endl;
+            failures++;
+        }
+    };
+
+    // Red at (5, 5) moving RIGHT ricochets up, left and down through its own
+    // start cell and on to the bottom wall; it must not stop at (5, 4).
+    {
+        Board board(16, 16);
+        board.addDiagonalWall(8, 5, 'G', DiagonalOrientation::NE_SW);
+        board.addDiagonalWall(8, 2, 'G', DiagonalOrientation::NW_SE);
+        board.addDiagonalWall(5, 2, 'G', DiagonalOrientation::NE_SW);
+        board.setTarget(5, 4, 'R');
+        CompiledBoard compiled(board);
+        Solver solver(compiled, encode(std::array<std::pair<int, int>, 5>{{{5, 5}, {0, 0}, {15, 0}, {0, 15}, {15, 15}}}));
+        solver.setLimits(std::chrono::milliseconds(0), 20000);
+        std::vector<Move> solution = solver.solve_sequential();
+        check(solution.size() != 1 && solver.getStats().exhaustedDepth >= 1,
+              "slide crossing its own start cell is not blocked by it");
+        check(solver.solve_bidirectional().size() != 1 && solver.getStats().exhaustedDepth >= 1,
+              "backward regression does not stop a slide against its own start cell");
+
+        std::array<uint64_t, 4> others{};
+        for (int cell : {0, 15, 15 * 16, 15 * 16 + 15}) others[cell >> 6] |= uint64_t{1} << (cell & 63);
+        std::vector<SlideTable::Origin> arrived;
+        compiled.getSlides().arrivals(15 * 16 + 5, 0, others, arrived);
+        check(std::any_of(arrived.begin(), arrived.end(), [](const SlideTable::Origin& o) {
+                  return o.start == 5 * 16 + 5 && o.dir == dirToIndex(Direction::RIGHT);
+              }), "reverse moves include a ricochet through its own start cell");
+        compiled.getSlides().arrivals(4 * 16 + 5, 0, others, arrived);
+        check(std::none_of(arrived.begin(), arrived.end(), [](const SlideTable::Origin& o) {
+                  return o.start == 5 * 16 + 5;
+              }), "reverse moves do not stop a slide against its own start cell");
+    }
+
+    return failures;
 }
 
-int main() {
+int main(int argc, char* argv[]) {
     const int BOARD_SIZE = 16;
     Board board(BOARD_SIZE, BOARD_SIZE);
 
+    if (argc > 1 && std::string(argv[1]) == "--self-test") {
+        int failures = runSelfTests(std::cerr);
+        std::cout << (failures ? "self-test failed" : "self-test passed") << std::endl;
+        return failures ? 1 : 0;
+    }
+
+    if (argc > 1 && std::string(argv[1]) == "--batch") {
+        std::string cacheFile;
+        std::chrono::milliseconds timeout(0);
+        uint64_t maxNodes = DEFAULT_BATCH_NODES;
+        size_t memoryBytes = DEFAULT_BATCH_MEMORY;
+        size_t cacheBytes = 0;
+        try {
+            if (argc < 4) throw std::invalid_argument("missing arguments");
+            for (int i = 4; i < argc; ++i) {
+                std::string arg = argv[i];
+                if ((arg == "--max-nodes" || arg == "--timeout" || arg == "--memory" || arg == "--cache") &&
+                    i + 1 < argc) {
+                    long long value = std::stoll(argv[++i]);
+                    if (value < 0) throw std::invalid_argument(arg + " must not be negative");
+                    if (arg == "--max-nodes") {
+                        maxNodes = static_cast<uint64_t>(value);
+                    } else if (arg == "--memory") {
+                        memoryBytes = static_cast<size_t>(value) << 20;
+                    } else if (arg == "--cache") {
+                        if (value == 0) throw std::invalid_argument("--cache must be positive");
+                        cacheBytes = static_cast<size_t>(value) << 20;
+                    } else {
+                        timeout = std::chrono::milliseconds(value);
+                    }
+                } else if (arg.rfind("--", 0) != 0 && cacheFile.empty()) {
+                    cacheFile = arg;
+                } else {
+                    throw std::invalid_argument("unexpected argument " + arg);
+                }
+            }
+        } catch (const std::logic_error&) {
+            std::cerr << "Usage: " << argv[0] << " --batch <board file> <jobs file | -> [solution cache file]" << std::endl
+                      << "       [--max-nodes <n>] [--timeout <ms>]   (per group of jobs sharing a start;" << std::endl
+                      << "       default " << DEFAULT_BATCH_NODES << " nodes, 0 disables; jobs cut off are \"unsolved\")" << std::endl
+                      << "       [--memory <MiB>]   (bounds concurrent groups; default " << (DEFAULT_BATCH_MEMORY >> 20)
+                      << ")" << std::endl
+                      << "       [--cache <MiB>]   (solution cache budget; without a cache file it is in memory only)"
+                      << std::endl;
+            return 1;
+        }
+        try {
+            CompiledBoard compiled(loadBoardImage(argv[2]));
+            std::vector<BatchJob> jobs;
+            if (std::string(argv[3]) == "-") {
+                jobs = readBatchJobs(std::cin);
+            } else {
+                std::ifstream jobs_file(argv[3]);
+                if (!jobs_file.is_open()) {
+                    throw std::runtime_error(std::string("Could not open file: ") + argv[3]);
+                }
+                jobs = readBatchJobs(jobs_file);
+            }
+            std::unique_ptr<SolutionCache> cache;
+            if (!cacheFile.empty() || cacheBytes) {
+                cache = std::make_unique<SolutionCache>(cacheBytes ? cacheBytes : SolutionCache::DEFAULT_MEMORY_BUDGET,
+                                                        cacheFile);
+            }
+            runBatch(compiled, jobs, std::cout, cache.get(), timeout, maxNodes, memoryBytes);
+            if (cache) reportCacheStats(*cache);
+        } catch (const std::exception& e) {
+            std::cerr << "Error in batch mode: " << e.what() << std::endl;
+            return 1;
+        }
+        return 0;
+    }
+
+    if (argc > 1 && std::string(argv[1]) == "--solve") {
+        try {
+            std::vector<std::string> args(argv + 2, argv + argc);
+            std::unique_ptr<SolutionCache> cache = takeCacheFlags(args);
+            SolveRequest request = parseSolveRequest(args);
+            runSolveRequest(CompiledBoard(loadBoardImage(request.board)), request, std::cout, nullptr, cache.get());
+            if (cache) reportCacheStats(*cache);
+        } catch (const std::exception& e) {
+            std::cerr << "Error: " << e.what() << std::endl
+                      << "Usage: " << argv[0] << " --solve [--board <file>] --robots <x y>... --target <color x y>" << std::endl
+                      << "       [--engine sequential|sequential-compact|parallel|bidirectional|ida|staged|external]" << std::endl
+                      << "       [--threads <n>] [--timeout <ms>] [--max-nodes <n>] [--memory <MiB>]" << std::endl
+                      << "       [--canonical] [--levels] [--id <token>] [--priority <n>]" << std::endl
+                      << "       [--cache <MiB>] [--cache-file <file>]" << std::endl;
+            return 1;
+        }
+        return 0;
+    }
+
+    if (argc > 1 && std::string(argv[1]) == "--serve") {
+        int workers = 0;
+        std::unique_ptr<SolutionCache> cache;
+        try {
+            std::vector<std::string> args(argv + 2, argv + argc);
+            cache = takeCacheFlags(args);
+            if (args.size() > 1) throw std::invalid_argument("too many arguments");
+            if (args.size() == 1) workers = std::stoi(args[0]);
+            if (args.size() == 1 && workers < 1) throw std::invalid_argument("worker count must be positive");
+        } catch (const std::exception& e) {
+            std::cerr << "Error: " << e.what() << std::endl
+                      << "Usage: " << argv[0] << " --serve [workers] [--cache <MiB>] [--cache-file <file>]" << std::endl
+                      << "       (reads --solve flag lines from stdin; with workers, runs them concurrently and" << std::endl
+                      << "       answers in completion order; a cache answers repeated queries without searching)"
+                      << std::endl;
+            return 1;
+        }
+        serveRequests(std::cin, std::cout, workers, cache.get());
+        if (cache) reportCacheStats(*cache);
+        return 0;
+    }
+
+    if (argc > 1 && std::string(argv[1]) == "--convert") {
+        if (argc < 4) {
+            std::cerr << "Usage: " << argv[0] << " --convert <text board> <binary board> [robot positions as x y ... [color x y]]" << std::endl
+                      << "       " << argv[0] << " --convert <binary board> <text board>" << std::endl;
+            return 1;
+        }
+        try {
+            if (isBinaryBoard(argv[2])) {
+                saveBoardText(loadBoardBinary(argv[2]), argv[3]);
+            } else {
+                BoardImage image = loadBoardText(argv[2]);
+                if (argc > 4) {
+                    std::string line;
+                    for (int i = 4; i < argc; ++i) line += std::string(argv[i]) + ' ';
+                    // Robots alone are accepted too: append a dummy target for parsing.
+                    bool hasTarget = argc - 3 >= 4 && std::isalpha(static_cast<unsigned char>(argv[argc - 3][0]));
+                    BatchJob job = parseBatchJob(hasTarget ? line : line + "R 0 0", 0);
+                    image.robotCount = job.robotCount;
+                    for (int r = 0; r < job.robotCount; ++r) {
+                        auto [x, y] = job.robots[r];
+                        if (x < 0 || x >= image.width || y < 0 || y >= image.height) {
+                            throw std::runtime_error("Robot position out of bounds");
+                        }
+                        image.robots[r] = static_cast<uint8_t>(x | (y << 4));
+                    }
+                    if (hasTarget) {
+                        if (job.x < 0 || job.x >= image.width || job.y < 0 || job.y >= image.height) {
+                            throw std::runtime_error("Target out of bounds");
+                        }
+                        image.targetRobot = Board::robotColorToIndex.at(job.color);
+                        image.targetCell = job.y * image.width + job.x;
+                    }
+                }
+                saveBoardBinary(image, argv[3]);
+            }
+        } catch (const std::exception& e) {
+            std::cerr << "Error converting board: " << e.what() << std::endl;
+            return 1;
+        }
+        return 0;
+    }
+
+    if (argc > 1 && std::string(argv[1]) == "--compose") {
+        if (argc < 7 || argc > 8) {
+            std::cerr << "Usage: " << argv[0] << " --compose <top-left> <top-right> <bottom-right> <bottom-left> <binary board> [tile directory]" << std::endl
+                      << "       Each quadrant is a tile ID from the directory or an 8x8 tile file." << std::endl;
+            return 1;
+        }
+        try {
+            QuadrantLibrary library;
+            if (argc == 8) library.loadDirectory(argv[7]);
+            std::array<std::string, 4> ids;
+            for (int i = 0; i < 4; ++i) ids[i] = library.resolve(argv[2 + i]);
+            saveBoardBinary(library.compose(ids).image, argv[6]);
+        } catch (const std::exception& e) {
+            std::cerr << "Error composing board: " << e.what() << std::endl;
+            return 1;
+        }
+        return 0;
+    }
+
+    if (argc > 1 && std::string(argv[1]) == "--bench") {
+        if (argc < 7) {
+            std::cerr << "Usage: " << argv[0] << " --bench <max moves> <configs per board> <max threads> <seed> <board files...>" << std::endl;
+            return 1;
+        }
+        try {
+            int maxThreads = std::stoi(argv[4]);
+            if (maxThreads < 1) throw std::runtime_error("Thread count must be at least 1");
+            runBenchmark(std::vector<std::string>(argv + 6, argv + argc), std::stoi(argv[2]),
+                         std::stoi(argv[3]), maxThreads, static_cast<unsigned>(std::stoul(argv[5])), std::cout);
+        } catch (const std::exception& e) {
+            std::cerr << "Error in benchmark: " << e.what() << std::endl;
+            return 1;
+        }
+        return 0;
+    }
+
+    if (argc > 1 && std::string(argv[1]) == "--build-db") {
+        if (argc != 15) {
+            std::cerr << "Usage: " << argv[0] << " --build-db <board file> <db file> <max depth> <R B G Y P positions as x y>" << std::endl;
+            return 1;
+        }
+        try {
+            CompiledBoard compiled(loadBoardImage(argv[2]));
+            State initial = encode(parsePositions(argv, 5, compiled.getWidth(), compiled.getHeight()));
+            auto start = std::chrono::high_resolution_clock::now();
+            DistanceDatabase db = DistanceDatabase::build(compiled, initial, std::stoi(argv[4]));
+            std::chrono::duration<double> elapsed = std::chrono::high_resolution_clock::now() - start;
+            db.save(argv[3]);
+            int reached = 0;
+            for (int robot = 0; robot < 5; ++robot) {
+                for (int cell = 0; cell < compiled.getWidth() * compiled.getHeight(); ++cell) {
+                    if (db.distance(robot, cell) >= 0) reached++;
+                }
+            }
+            std::cout << "Wrote " << argv[3] << ": " << reached << " of " << 5 * compiled.getWidth() * compiled.getHeight()
+                      << " (robot, cell) pairs within " << db.getMaxDepth() << " moves ("
+                      << elapsed.count() << " seconds)" << std::endl;
+        } catch (const std::exception& e) {
+            std::cerr << "Error building database: " << e.what() << std::endl;
+            return 1;
+        }
+        return 0;
+    }
+
+    if (argc > 1 && std::string(argv[1]) == "--query-db") {
+        if (argc != 17) {
+            std::cerr << "Usage: " << argv[0] << " --query-db <board file> <db file> <R B G Y P positions as x y> <color> <x> <y>" << std::endl;
+            return 1;
+        }
+        try {
+            CompiledBoard compiled(loadBoardImage(argv[2]));
+            State initial = encode(parsePositions(argv, 4, compiled.getWidth(), compiled.getHeight()));
+            DistanceDatabase db = DistanceDatabase::load(argv[3], compiled, initial);
+            char color = static_cast<char>(std::toupper(argv[14][0]));
+            int x = std::stoi(argv[15]);
+            int y = std::stoi(argv[16]);
+            if (!Board::robotColorToIndex.count(color) || x < 0 || x >= compiled.getWidth() || y < 0 || y >= compiled.getHeight()) {
+                throw std::runtime_error("Invalid target");
+            }
+            auto path = db.lookup(Board::robotColorToIndex.at(color), y * compiled.getWidth() + x);
+            std::cout << color << ',' << x << ',' << y << ','
+                      << (path ? static_cast<long>(path->size()) : -1L) << ','
+                      << (path ? formatMoves(*path) : "") << std::endl;
+        } catch (const std::exception& e) {
+            std::cerr << "Error querying database: " << e.what() << std::endl;
+            return 1;
+        }
+        return 0;
+    }
+
     std::array<std::pair<int, int>, 5> initial_positions = {{
         {0, 1}, {15, 1}, {14, 14}, {0, 0}, {7, 8}
     }};
@@ -788,15 +4896,16 @@ int main() {
     State initial_state = encode(initial_positions);
 
     char solver_choice = ' ';
-    while (solver_choice != 's' && solver_choice != 'p') {
-        std::cout << "\nChoose solver type (s = sequential, p = parallel): ";
+    const std::string solver_choices = "spbite";
+    while (solver_choices.find(solver_choice) == std::string::npos) {
+        std::cout << "\nChoose solver type (s = sequential, p = parallel, b = bidirectional, i = IDA*, t = staged, e = external): ";
         if (!(std::cin >> solver_choice)) {
              std::cerr << "Error reading input. Exiting." << std::endl;
              return 1; 
         }
         solver_choice = std::tolower(solver_choice);
-        if (solver_choice != 's' && solver_choice != 'p') {
-            std::cerr << "Invalid choice. Please enter 's' or 'p'." << std::endl;
+        if (solver_choices.find(solver_choice) == std::string::npos) {
+            std::cerr << "Invalid choice. Please enter 's', 'p', 'b', 'i', 't' or 'e'." << std::endl;
             std::cin.clear(); 
             std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
         }
@@ -805,71 +4914,68 @@ int main() {
 
 
     try {
-        Solver solver(board, initial_state);
+        CompiledBoard compiled(board);
+        Solver solver(compiled, initial_state);
+        solver.setLevelCallback([](const LevelStats& level) {
+            std::cerr << "  level " << level.depth << ": frontier " << level.frontier
+                      << ", new " << level.inserted << ", duplicates " << level.duplicates
+                      << ", load " << level.loadFactor << ", " << level.seconds << " s" << std::endl;
+        });
         std::vector<Move> solution;
         std::chrono::duration<double> elapsed_time;
+        std::string label;
 
+        auto start = std::chrono::high_resolution_clock::now();
         if (solver_choice == 's') {
+            label = "Sequential";
             std::cout << "\n--- Running Sequential Solver ---" << std::endl << std::flush; 
-            auto start_seq = std::chrono::high_resolution_clock::now();
             solution = solver.solve_sequential();
-            auto end_seq = std::chrono::high_resolution_clock::now();
-            elapsed_time = end_seq - start_seq;
-
-            if (solution.empty()) {
-                std::cout << "Sequential: No solution found." << std::endl << std::flush; 
-            } else {
-                std::cout << "Sequential: Solution found in " << solution.size() << " moves ("
-                          << elapsed_time.count() << " seconds):\n" << std::flush; 
-                char robot_chars[] = {'R', 'B', 'G', 'Y', 'P'};
-                for (const auto& move : solution) {
-                    std::string dir_str;
-                    switch(move.dir) {
-                        case Direction::UP:    dir_str = "UP"; break;
-                        case Direction::DOWN:  dir_str = "DOWN"; break;
-                        case Direction::LEFT:  dir_str = "LEFT"; break;
-                        case Direction::RIGHT: dir_str = "RIGHT"; break;
-                        default:               dir_str = "?"; break;
-                    }
-                    if (move.robot >= 0 && move.robot < 5) {
-                       std::cout << "  Robot " << robot_chars[move.robot] << " (" << move.robot << ") -> " << dir_str << "\n";
-                    } else {
-                       std::cout << "  Invalid robot index in move: " << move.robot << "\n";
-                    }
-                }
-                 std::cout << std::flush; 
-            }
-
-        } else { 
+        } else if (solver_choice == 'p') {
+            label = "Parallel";
             std::cout << "\n--- Running Parallel Solver (TBB) ---" << std::endl << std::flush; 
-            auto start_par = std::chrono::high_resolution_clock::now();
             solution = solver.solve(); 
-            auto end_par = std::chrono::high_resolution_clock::now();
-            elapsed_time = end_par - start_par;
-
-            if (solution.empty()) {
-                std::cout << "Parallel: No solution found." << std::endl << std::flush; 
-            } else {
-                std::cout << "Parallel: Solution found in " << solution.size() << " moves ("
-                          << elapsed_time.count() << " seconds):\n" << std::flush; 
-                char robot_chars[] = {'R', 'B', 'G', 'Y', 'P'};
-                for (const auto& move : solution) {
-                    std::string dir_str;
-                    switch(move.dir) {
-                        case Direction::UP:    dir_str = "UP"; break;
-                        case Direction::DOWN:  dir_str = "DOWN"; break;
-                        case Direction::LEFT:  dir_str = "LEFT"; break;
-                        case Direction::RIGHT: dir_str = "RIGHT"; break;
-                        default:               dir_str = "?"; break;
-                    }
-                    if (move.robot >= 0 && move.robot < 5) {
-                       std::cout << "  Robot " << robot_chars[move.robot] << " (" << move.robot << ") -> " << dir_str << "\n";
-                    } else {
-                       std::cout << "  Invalid robot index in move: " << move.robot << "\n";
-                    }
+        } else if (solver_choice == 'b') {
+            label = "Bidirectional";
+            std::cout << "\n--- Running Bidirectional Solver ---" << std::endl << std::flush; 
+            solution = solver.solve_bidirectional();
+        } else if (solver_choice == 'i') {
+            label = "IDA*";
+            std::cout << "\n--- Running IDA* Solver ---" << std::endl << std::flush; 
+            solution = solver.solve_ida();
+        } else if (solver_choice == 't') {
+            label = "Staged";
+            std::cout << "\n--- Running Staged Solver ---" << std::endl << std::flush; 
+            solution = solver.solve_staged();
+        } else {
+            label = "External";
+            std::cout << "\n--- Running External-Memory Solver ---" << std::endl << std::flush; 
+            solution = solver.solve_external();
+        }
+        auto end = std::chrono::high_resolution_clock::now();
+        elapsed_time = end - start;
+
+        if (solution.empty()) {
+            std::cout << label << ": No solution found." << std::endl << std::flush; 
+        } else {
+            std::cout << label << ": Solution found in " << solution.size() << " moves ("
+                      << elapsed_time.count() << " seconds):\n" << std::flush; 
+            char robot_chars[] = {'R', 'B', 'G', 'Y', 'P'};
+            for (const auto& move : solution) {
+                std::string dir_str;
+                switch(move.dir) {
+                    case Direction::UP:    dir_str = "UP"; break;
+                    case Direction::DOWN:  dir_str = "DOWN"; break;
+                    case Direction::LEFT:  dir_str = "LEFT"; break;
+                    case Direction::RIGHT: dir_str = "RIGHT"; break;
+                    default:               dir_str = "?"; break;
+                }
+                if (move.robot >= 0 && move.robot < 5) {
+                   std::cout << "  Robot " << robot_chars[move.robot] << " (" << move.robot << ") -> " << dir_str << "\n";
+                } else {
+                   std::cout << "  Invalid robot index in move: " << move.robot << "\n";
                 }
-                 std::cout << std::flush; 
             }
+             std::cout << std::flush; 
         }
 
     } catch (const std::exception& e) {